@@ -0,0 +1,252 @@
+#include "BatchDriver.h"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string_view>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr std::size_t kStreamBufferBytes = 1 << 20;
+
+const char* skipSpaces(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+    return p;
+}
+
+// Parses the next whitespace-separated integer. Returns false if there is none.
+template <typename T>
+bool nextInt(const char*& p, const char* end, T& value) {
+    p = skipSpaces(p, end);
+    auto result = std::from_chars(p, end, value);
+    if (result.ec != std::errc()) return false;
+    p = result.ptr;
+    return true;
+}
+
+// Takes the next whitespace-separated word, empty at the end of the line.
+std::string_view nextWord(const char*& p, const char* end) {
+    p = skipSpaces(p, end);
+    const char* word = p;
+    while (p < end && *p != ' ' && *p != '\t' && *p != '\r') ++p;
+    return std::string_view(word, static_cast<std::size_t>(p - word));
+}
+
+// Reads an optional trailing time in force: gtc, ioc or fok.
+TimeInForce parseTimeInForce(const char*& p, const char* end, TimeInForce fallback) {
+    std::string_view word = nextWord(p, end);
+    if (word.empty()) return fallback;
+    if (word == "gtc") return TimeInForce::GTC;
+    if (word == "ioc") return TimeInForce::IOC;
+    if (word == "fok") return TimeInForce::FOK;
+    throw std::invalid_argument("unknown time in force '" + std::string(word) + "'");
+}
+
+// Runs one book operation and records how long it took, even if the book rejects it.
+template <typename F>
+void timed(std::vector<uint32_t>& latencies, F&& apply) {
+    auto start = std::chrono::steady_clock::now();
+    auto record = [&] {
+        auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        latencies.push_back(static_cast<uint32_t>(std::min<int64_t>(nanos.count(), UINT32_MAX)));
+    };
+    try {
+        apply();
+    } catch (...) {
+        record();
+        throw;
+    }
+    record();
+}
+
+uint64_t percentile(std::vector<uint32_t>& sorted, double fraction) {
+    if (sorted.empty()) return 0;
+    std::size_t rank = static_cast<std::size_t>(fraction * static_cast<double>(sorted.size() - 1));
+    return sorted[rank];
+}
+
+} // namespace
+
+bool BatchDriver::run(const std::string& path) {
+    totals = BatchReport{};
+    latencies.clear();
+    uint64_t startTrades = book.tradeCount();
+    auto start = std::chrono::steady_clock::now();
+
+    if (path == "-") {
+        runStream();
+    } else {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        std::size_t size = ::fstat(fd, &st) == 0 ? static_cast<std::size_t>(st.st_size) : 0;
+        if (size > 0) {
+            void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) {
+                ::close(fd);
+                return false;
+            }
+            ::madvise(mapping, size, MADV_SEQUENTIAL);
+            // A command line is rarely shorter than 12 bytes.
+            latencies.reserve(std::min<std::size_t>(size / 12, std::size_t(1) << 24));
+            const char* data = static_cast<const char*>(mapping);
+            runBuffer(data, data + size);
+            ::munmap(mapping, size);
+        }
+        ::close(fd);
+    }
+
+    totals.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    finish(startTrades);
+    return true;
+}
+
+// Runs every line in [begin, end); a last line without a newline counts too.
+bool BatchDriver::runBuffer(const char* begin, const char* end) {
+    const char* p = begin;
+    while (p < end) {
+        const char* eol = static_cast<const char*>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)));
+        if (!eol) eol = end;
+        if (!runLine(p, eol)) return false;
+        p = eol + 1;
+    }
+    return true;
+}
+
+bool BatchDriver::runStream() {
+    std::vector<char> buffer(kStreamBufferBytes);
+    std::size_t filled = 0;
+    while (true) {
+        std::size_t n = std::fread(buffer.data() + filled, 1, buffer.size() - filled, stdin);
+        filled += n;
+        if (n == 0) {
+            // End of input: whatever is left is the last line.
+            return runBuffer(buffer.data(), buffer.data() + filled);
+        }
+
+        // Run the complete lines and keep the partial one for the next read.
+        const char* data = buffer.data();
+        const char* lastNewline = nullptr;
+        for (const char* q = data + filled; q > data;) {
+            if (*--q == '\n') {
+                lastNewline = q;
+                break;
+            }
+        }
+        if (!lastNewline) {
+            if (filled == buffer.size()) buffer.resize(buffer.size() * 2); // a very long line
+            continue;
+        }
+        if (!runBuffer(data, lastNewline)) return false;
+        std::size_t consumed = static_cast<std::size_t>(lastNewline + 1 - data);
+        std::memmove(buffer.data(), data + consumed, filled - consumed);
+        filled -= consumed;
+    }
+}
+
+bool BatchDriver::runLine(const char* begin, const char* end) {
+    ++totals.lines;
+    const char* p = begin;
+    std::string_view cmd = nextWord(p, end);
+    if (cmd.empty()) return true;
+
+    try {
+        if (cmd == "buy" || cmd == "sell") {
+            OrderType type = cmd == "buy" ? OrderType::BUY : OrderType::SELL;
+            int price, quantity;
+            const char* afterSide = p;
+            if (nextWord(p, end) == "market") {
+                if (!nextInt(p, end, quantity)) throw std::invalid_argument("expected a quantity");
+                TimeInForce timeInForce = parseTimeInForce(p, end, TimeInForce::IOC);
+                timed(latencies, [&] { book.placeMarketOrder(type, quantity, timeInForce, session); });
+            } else {
+                p = afterSide;
+                if (!nextInt(p, end, price) || !nextInt(p, end, quantity)) {
+                    throw std::invalid_argument("expected a price and a quantity");
+                }
+                TimeInForce timeInForce = parseTimeInForce(p, end, TimeInForce::GTC);
+                timed(latencies, [&] { book.placeOrder(type, price, quantity, timeInForce, session); });
+            }
+            ++totals.orders;
+        } else if (cmd == "cancel") {
+            OrderId id;
+            if (!nextInt(p, end, id)) {
+                throw std::invalid_argument("expected an order ID");
+            }
+            timed(latencies, [&] { book.cancelOrder(id); });
+            ++totals.cancels;
+        } else if (cmd == "modify") {
+            OrderId id;
+            int price, quantity;
+            if (!nextInt(p, end, id) || !nextInt(p, end, price) || !nextInt(p, end, quantity)) {
+                throw std::invalid_argument("expected an order ID, a price and a quantity");
+            }
+            timed(latencies, [&] { book.modifyOrder(id, price, quantity); });
+            ++totals.modifies;
+        } else if (cmd == "masscancel") {
+            MassCancelFilter filter;
+            std::string_view side = nextWord(p, end);
+            if (side == "buy" || side == "sell") {
+                filter.side = side == "buy" ? OrderType::BUY : OrderType::SELL;
+            } else if (side != "all") {
+                throw std::invalid_argument("expected buy, sell or all");
+            }
+            int minPrice, maxPrice, owner;
+            if (!nextInt(p, end, minPrice) || !nextInt(p, end, maxPrice) || !nextInt(p, end, owner)) {
+                throw std::invalid_argument("expected a lowest price, a highest price and an owner");
+            }
+            if (owner < 0 || owner > UINT16_MAX) {
+                throw std::invalid_argument("expected an owner ID");
+            }
+            filter.minPrice = minPrice;
+            if (maxPrice > 0) filter.maxPrice = maxPrice;
+            filter.owner = static_cast<uint16_t>(owner);
+            timed(latencies, [&] { book.massCancel(filter); });
+            ++totals.massCancels;
+        } else if (cmd == "session") {
+            int owner;
+            if (!nextInt(p, end, owner) || owner < 0 || owner > UINT16_MAX) {
+                throw std::invalid_argument("expected an owner ID");
+            }
+            session = static_cast<uint16_t>(owner);
+        } else if (cmd == "book" || cmd == "log") {
+            // Console display commands; batch runs print nothing per command.
+        } else if (cmd == "exit") {
+            return false;
+        } else {
+            throw std::invalid_argument("unknown command '" + std::string(cmd) + "'");
+        }
+    } catch (const std::exception& e) {
+        ++totals.rejected;
+        std::cerr << "Error: line " << totals.lines << ": " << e.what() << std::endl;
+    }
+    return true;
+}
+
+void BatchDriver::finish(uint64_t startTrades) {
+    totals.trades = book.tradeCount() - startTrades;
+    std::sort(latencies.begin(), latencies.end());
+    totals.p50 = percentile(latencies, 0.50);
+    totals.p99 = percentile(latencies, 0.99);
+    totals.p999 = percentile(latencies, 0.999);
+    totals.max = latencies.empty() ? 0 : latencies.back();
+}
+
+void BatchDriver::printReport(std::ostream& out) const {
+    double seconds = totals.seconds > 0 ? totals.seconds : 1e-9;
+    out << "Batch: " << totals.lines << " lines, " << totals.orders << " orders, " << totals.cancels << " cancels, "
+        << totals.modifies << " modifies, " << totals.massCancels << " mass cancels, "
+        << totals.rejected << " rejected, " << totals.trades << " trades in " << totals.seconds * 1000 << " ms\n"
+        << "Throughput: " << static_cast<uint64_t>(totals.orders / seconds) << " orders/sec, "
+        << static_cast<uint64_t>(totals.trades / seconds) << " trades/sec\n"
+        << "Latency (ns): p50 " << totals.p50 << ", p99 " << totals.p99 << ", p99.9 " << totals.p999
+        << ", max " << totals.max << std::endl;
+}
@@ -0,0 +1,60 @@
+#ifndef BATCH_DRIVER_H
+#define BATCH_DRIVER_H
+
+#include "OrderBook.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Totals for one batch run.
+struct BatchReport {
+    uint64_t lines = 0;
+    uint64_t orders = 0;   // buy and sell commands applied
+    uint64_t cancels = 0;  // cancel commands applied
+    uint64_t modifies = 0; // modify commands applied
+    uint64_t massCancels = 0; // masscancel commands applied
+    uint64_t rejected = 0; // commands the book refused, or lines that did not parse
+    uint64_t trades = 0;
+    double seconds = 0;
+    // Per-command latency of placeOrder/cancelOrder/modifyOrder/massCancel, in nanoseconds.
+    uint64_t p50 = 0, p99 = 0, p999 = 0, max = 0;
+};
+
+// Replays a command file (the console's "buy P Q", "sell P Q", "cancel ID",
+// "modify ID P Q" and "exit" lines) into an OrderBook without prompts. An order line may
+// end in a time in force ("buy P Q ioc", "sell P Q fok"), and "buy market Q"
+// places a market order (IOC unless followed by fok). "masscancel buy|sell|all
+// MIN MAX OWNER" cancels in bulk (0 for no upper price limit or any owner), and
+// "session OWNER" sets the owner of the orders that follow. The console's "book"
+// and "log" display commands are accepted and skipped. Regular files are
+// mapped and parsed in place; "-" streams standard input through a fixed buffer.
+// Pair it with OrderBookConfig::quiet so trades are not printed one by one.
+class BatchDriver {
+public:
+    explicit BatchDriver(OrderBook& book) : book(book) {}
+
+    // Runs every command in the file. Returns false if it cannot be opened.
+    bool run(const std::string& path);
+
+    const BatchReport& report() const { return totals; }
+
+    // Prints orders/sec, trades/sec and the latency summary.
+    void printReport(std::ostream& out) const;
+
+private:
+    // Applies one line. Returns false on "exit".
+    bool runLine(const char* begin, const char* end);
+    bool runBuffer(const char* begin, const char* end);
+    bool runStream();
+    void finish(uint64_t startTrades);
+
+    OrderBook& book;
+    BatchReport totals;
+    uint16_t session = 0; // owner given to placed orders
+    std::vector<uint32_t> latencies;
+};
+
+#endif // BATCH_DRIVER_H
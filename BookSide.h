@@ -0,0 +1,324 @@
+#ifndef BOOK_SIDE_H
+#define BOOK_SIDE_H
+
+#include "Order.h"
+#include "PriceLevel.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+// A hierarchical occupancy bitmap: one bit per tick in the bottom layer and
+// one bit per non-empty word in each layer above it, up to a single word.
+// Finding the next occupied tick in either direction is a handful of word scans.
+class LevelBitmap {
+public:
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    void reset(std::size_t bits) {
+        layers.clear();
+        do {
+            std::size_t words = (bits + 63) / 64;
+            layers.emplace_back(words, 0);
+            bits = words;
+        } while (bits > 1);
+    }
+
+    bool any() const { return layers.back()[0] != 0; }
+
+    void set(std::size_t i) {
+        for (auto& layer : layers) {
+            uint64_t& word = layer[i >> 6];
+            bool wasEmpty = word == 0;
+            word |= uint64_t(1) << (i & 63);
+            if (!wasEmpty) break; // The layers above already know about this word.
+            i >>= 6;
+        }
+    }
+
+    void clear(std::size_t i) {
+        for (auto& layer : layers) {
+            uint64_t& word = layer[i >> 6];
+            word &= ~(uint64_t(1) << (i & 63));
+            if (word != 0) break; // The word is still occupied, so the layers above stay set.
+            i >>= 6;
+        }
+    }
+
+    // Lowest set bit at or above i, or npos.
+    std::size_t nextAtOrAbove(std::size_t i) const {
+        for (std::size_t l = 0; l < layers.size(); ++l) {
+            std::size_t w = i >> 6;
+            if (w >= layers[l].size()) return npos;
+            uint64_t bits = layers[l][w] & (~uint64_t(0) << (i & 63));
+            if (bits) {
+                std::size_t idx = (w << 6) | __builtin_ctzll(bits);
+                while (l-- > 0) idx = (idx << 6) | __builtin_ctzll(layers[l][idx]);
+                return idx;
+            }
+            i = w + 1;
+        }
+        return npos;
+    }
+
+    // Highest set bit at or below i, or npos.
+    std::size_t nextAtOrBelow(std::size_t i) const {
+        for (std::size_t l = 0; l < layers.size(); ++l) {
+            std::size_t w = i >> 6;
+            uint64_t bits = layers[l][w] & (~uint64_t(0) >> (63 - (i & 63)));
+            if (bits) {
+                std::size_t idx = (w << 6) | (63 - __builtin_clzll(bits));
+                while (l-- > 0) idx = (idx << 6) | (63 - __builtin_clzll(layers[l][idx]));
+                return idx;
+            }
+            if (w == 0) return npos;
+            i = w - 1;
+        }
+        return npos;
+    }
+
+private:
+    std::vector<std::vector<uint64_t>> layers;
+};
+
+// One side of the book: the price levels of all resting buys or all resting sells.
+// Compare orders prices from best to worst (std::greater for buys, std::less for sells).
+//
+// By default levels live in a std::map, which accepts any price. After
+// useLadder(min, max) they live in a contiguous array indexed by tick instead,
+// with a LevelBitmap to find the best and next-best occupied prices.
+template <typename Compare>
+class BookSide {
+public:
+    // Switches this side to a tick-indexed ladder covering [minPrice, maxPrice].
+    // Must be called while the side is still empty.
+    void useLadder(int minPrice, int maxPrice) {
+        if (minPrice <= 0 || maxPrice < minPrice) {
+            throw std::invalid_argument("Ladder price band must be positive and non-empty");
+        }
+        ladder = true;
+        ladderMin = minPrice;
+        ladderMax = maxPrice;
+        ladderLevels.assign(static_cast<std::size_t>(maxPrice - minPrice) + 1, PriceLevel{});
+        occupied.reset(ladderLevels.size());
+    }
+
+    bool isLadder() const { return ladder; }
+
+    // Pre-allocates map nodes for this many price levels. Emptied levels are
+    // parked here and reused for new prices, so the map stops allocating once
+    // the number of live levels stays within the reserve. Unused by the ladder.
+    void reserveLevels(std::size_t count) {
+        spareLevels.reserve(count);
+        while (spareLevels.size() < count) {
+            LevelMap scratch;
+            scratch.emplace(0, PriceLevel{});
+            spareLevels.push_back(scratch.extract(scratch.begin()));
+        }
+        spareTarget = count;
+    }
+
+    std::size_t levelCount() const { return ladder ? 0 : mapLevels.size(); }
+    std::size_t spareLevelCount() const { return spareLevels.size(); }
+    std::size_t levelAllocations() const { return levelAllocs; }
+
+    // Whether an order at this price can rest on this side.
+    bool accepts(int price) const { return !ladder || (price >= ladderMin && price <= ladderMax); }
+
+    bool empty() const { return ladder ? !occupied.any() : mapLevels.empty(); }
+
+    // Best price on this side. Only valid when the side is not empty.
+    int bestPrice() const { return ladder ? best : mapLevels.begin()->first; }
+
+    // Queue at the best price. Only valid when the side is not empty.
+    PriceLevel& bestLevel() { return ladder ? slot(best) : mapLevels.begin()->second; }
+    const PriceLevel& bestLevel() const { return ladder ? slot(best) : mapLevels.begin()->second; }
+
+    // Appends an order at the back of the queue for its price.
+    void push_back(Order* order) { levelFor(order->price).push_back(order); }
+
+    // Appends a linked run of orders that all rest at this price, in order,
+    // with a single level lookup. Used to bulk-load saved books.
+    void appendRun(int price, Order* first, Order* last) { levelFor(price).splice_back(first, last); }
+
+    // Unlinks a resting order, dropping its level if that leaves it empty.
+    // Returns false if no level exists at the order's price.
+    bool remove(Order* order) {
+        if (!ladder) {
+            auto it = mapLevels.find(order->price);
+            if (it == mapLevels.end()) return false;
+            it->second.erase(order);
+            if (it->second.empty()) dropLevel(it);
+            return true;
+        }
+        if (!accepts(order->price)) return false;
+        PriceLevel& level = slot(order->price);
+        if (level.empty()) return false;
+        level.erase(order);
+        if (level.empty()) eraseLevel(order->price);
+        return true;
+    }
+
+    // Records a fill against a resting order that is not at the front of the
+    // best level (journal replay). Matching fills through the level directly.
+    void fill(Order* order, int filled) {
+        if (!ladder) {
+            auto it = mapLevels.find(order->price);
+            if (it != mapLevels.end()) it->second.fill(*order, filled);
+            return;
+        }
+        if (accepts(order->price)) slot(order->price).fill(*order, filled);
+    }
+
+    // Changes a resting order's total quantity without moving it in its queue.
+    void resize(Order* order, int newQuantity) {
+        if (!ladder) {
+            auto it = mapLevels.find(order->price);
+            if (it != mapLevels.end()) it->second.resize(*order, newQuantity);
+            return;
+        }
+        if (accepts(order->price)) slot(order->price).resize(*order, newQuantity);
+    }
+
+    // Removes every level priced within [minPrice, maxPrice] in one pass,
+    // calling onLevel(price, level) for each just before it is dropped. The
+    // orders stay linked to each other, not to the book; onLevel disposes of
+    // them. Only the levels in the band are visited.
+    template <typename F>
+    void removeLevels(int minPrice, int maxPrice, F&& onLevel) {
+        if (!ladder) {
+            auto it = mapLevels.lower_bound(descending() ? maxPrice : minPrice);
+            while (it != mapLevels.end() && it->first >= minPrice && it->first <= maxPrice) {
+                auto next = std::next(it);
+                onLevel(it->first, it->second);
+                dropLevel(it);
+                it = next;
+            }
+            return;
+        }
+        minPrice = std::max(minPrice, ladderMin);
+        maxPrice = std::min(maxPrice, ladderMax);
+        if (minPrice > maxPrice || empty()) return;
+        std::size_t last = index(maxPrice);
+        for (std::size_t i = occupied.nextAtOrAbove(index(minPrice)); i != LevelBitmap::npos && i <= last;
+             i = occupied.nextAtOrAbove(i + 1)) {
+            onLevel(ladderMin + static_cast<int>(i), ladderLevels[i]);
+            ladderLevels[i] = PriceLevel{};
+            occupied.clear(i);
+        }
+        if (best >= minPrice && best <= maxPrice) {
+            // Everything in the band is gone, so the next best lies just outside it.
+            std::size_t next = descending() ? occupied.nextAtOrBelow(last) : occupied.nextAtOrAbove(index(minPrice));
+            best = next == LevelBitmap::npos ? 0 : ladderMin + static_cast<int>(next);
+        }
+    }
+
+    // Drops the (already empty) level at this price.
+    void eraseLevel(int price) {
+        if (!ladder) {
+            // Matching always drains the best level, so try the cheap erase first.
+            auto it = mapLevels.begin();
+            if (it == mapLevels.end() || it->first != price) it = mapLevels.find(price);
+            if (it != mapLevels.end()) dropLevel(it);
+            return;
+        }
+        occupied.clear(index(price));
+        if (price == best) {
+            std::size_t next = nextWorse(index(price));
+            best = next == LevelBitmap::npos ? 0 : ladderMin + static_cast<int>(next);
+        }
+    }
+
+    // Visits non-empty levels from best to worst as f(price, level).
+    // Iteration stops early when f returns false.
+    template <typename F>
+    void forEachLevel(F&& f) const {
+        if (!ladder) {
+            for (const auto& pair : mapLevels) {
+                if (!f(pair.first, pair.second)) return;
+            }
+            return;
+        }
+        if (empty()) return;
+        std::size_t i = index(best);
+        while (i != LevelBitmap::npos) {
+            if (!f(ladderMin + static_cast<int>(i), ladderLevels[i])) return;
+            i = nextWorse(i);
+        }
+    }
+
+private:
+    using LevelMap = std::map<int, PriceLevel, Compare>;
+
+    // The queue at this price, creating the level if there is none yet.
+    PriceLevel& levelFor(int price) {
+        if (!ladder) {
+            auto it = mapLevels.lower_bound(price);
+            if (it == mapLevels.end() || it->first != price) {
+                it = insertLevel(it, price);
+            }
+            return it->second;
+        }
+        PriceLevel& level = slot(price);
+        if (level.empty()) {
+            occupied.set(index(price));
+            if (best == 0 || Compare()(price, best)) best = price;
+        }
+        return level;
+    }
+
+    typename LevelMap::iterator insertLevel(typename LevelMap::iterator hint, int price) {
+        if (spareLevels.empty()) {
+            ++levelAllocs;
+            return mapLevels.emplace_hint(hint, price, PriceLevel{});
+        }
+        auto node = std::move(spareLevels.back());
+        spareLevels.pop_back();
+        node.key() = price;
+        node.mapped() = PriceLevel{};
+        return mapLevels.insert(hint, std::move(node));
+    }
+
+    void dropLevel(typename LevelMap::iterator it) {
+        if (spareLevels.size() < spareTarget) {
+            spareLevels.push_back(mapLevels.extract(it));
+        } else {
+            mapLevels.erase(it);
+        }
+    }
+
+    static constexpr bool descending() { return std::is_same<Compare, std::greater<int>>::value; }
+
+    // Next occupied tick after i in best-to-worst order, or npos.
+    std::size_t nextWorse(std::size_t i) const {
+        if (descending()) return i == 0 ? LevelBitmap::npos : occupied.nextAtOrBelow(i - 1);
+        return occupied.nextAtOrAbove(i + 1);
+    }
+
+    std::size_t index(int price) const { return static_cast<std::size_t>(price - ladderMin); }
+    PriceLevel& slot(int price) { return ladderLevels[index(price)]; }
+    const PriceLevel& slot(int price) const { return ladderLevels[index(price)]; }
+
+    LevelMap mapLevels;
+    std::vector<typename LevelMap::node_type> spareLevels;
+    std::size_t spareTarget = 0;
+    std::size_t levelAllocs = 0;
+
+    bool ladder = false;
+    int ladderMin = 0;
+    int ladderMax = 0;
+    int best = 0; // 0 while the ladder is empty; prices are always positive.
+    std::vector<PriceLevel> ladderLevels;
+    LevelBitmap occupied;
+};
+
+using BuyBook = BookSide<std::greater<int>>; // Buys, best is the highest price
+using SellBook = BookSide<std::less<int>>;   // Sells, best is the lowest price
+
+#endif // BOOK_SIDE_H
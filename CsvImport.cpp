@@ -0,0 +1,221 @@
+#include "CsvImport.h"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// Chunks smaller than this are not worth a thread of their own.
+constexpr std::size_t kMinChunkBytes = 256 * 1024;
+
+// A read-only mapping of a whole file.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& filename) {
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        opened = true;
+        struct stat st;
+        if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* p = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                ::madvise(p, static_cast<std::size_t>(st.st_size), MADV_SEQUENTIAL);
+                mapping = static_cast<const char*>(p);
+                length = static_cast<std::size_t>(st.st_size);
+            }
+        }
+        ::close(fd);
+    }
+
+    ~MappedFile() {
+        if (mapping) ::munmap(const_cast<char*>(mapping), length);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool isOpen() const { return opened; }
+    const char* data() const { return mapping; }
+    std::size_t size() const { return length; }
+
+private:
+    bool opened = false;
+    const char* mapping = nullptr;
+    std::size_t length = 0;
+};
+
+// Parses one comma-terminated (or line-terminated, for the last) integer field
+// starting at p and moves p past its separator.
+template <typename T>
+const char* parseField(const char*& p, const char* end, T& value, bool last) {
+    auto result = std::from_chars(p, end, value);
+    if (result.ec == std::errc::invalid_argument) return "invalid number";
+    if (result.ec == std::errc::result_out_of_range) return "number out of range";
+    p = result.ptr;
+    if (last) return p == end ? nullptr : "unexpected characters after the last field";
+    if (p == end || *p != ',') return "missing field";
+    ++p;
+    return nullptr;
+}
+
+// Row parsers: return nullptr on success or a short reason for rejecting the row.
+struct OrderRowParser {
+    OrderType type;
+
+    const char* operator()(const char* p, const char* end, SavedOrder& saved) const {
+        Order& o = saved.order;
+        const char* error;
+        if ((error = parseField(p, end, o.id, false))) return error;
+        if ((error = parseField(p, end, o.price, false))) return error;
+        if ((error = parseField(p, end, o.quantity, false))) return error;
+        if ((error = parseField(p, end, o.filled_quantity, false))) return error;
+        if ((error = parseField(p, end, saved.timestamp, true))) return error;
+        o.type = type;
+        return nullptr;
+    }
+};
+
+struct TradeRowParser {
+    const char* operator()(const char* p, const char* end, Trade& t) const {
+        const char* error;
+        if ((error = parseField(p, end, t.tradeId, false))) return error;
+        if ((error = parseField(p, end, t.buyOrderId, false))) return error;
+        if ((error = parseField(p, end, t.sellOrderId, false))) return error;
+        if ((error = parseField(p, end, t.price, false))) return error;
+        if ((error = parseField(p, end, t.quantity, false))) return error;
+        if ((error = parseField(p, end, t.timestamp, true))) return error;
+        return nullptr;
+    }
+};
+
+struct RowError {
+    std::size_t line; // relative to the start of the chunk
+    const char* text;
+    std::size_t length;
+    const char* reason;
+};
+
+// The rows of one newline-aligned slice of the file.
+template <typename Row>
+struct Chunk {
+    const char* begin = nullptr;
+    const char* end = nullptr;
+    std::size_t lines = 0;
+    std::size_t parsed = 0;
+    std::vector<Row> rows;
+    std::vector<RowError> errors;
+};
+
+template <typename Row, typename ParseRow>
+void parseChunk(Chunk<Row>& chunk, const ParseRow& parseRow) {
+    const char* p = chunk.begin;
+    while (p < chunk.end) {
+        const char* eol = static_cast<const char*>(std::memchr(p, '\n', static_cast<std::size_t>(chunk.end - p)));
+        if (!eol) eol = chunk.end;
+        const char* lineEnd = eol;
+        if (lineEnd > p && lineEnd[-1] == '\r') --lineEnd;
+        ++chunk.lines;
+
+        if (lineEnd > p) {
+            Row row{};
+            if (const char* reason = parseRow(p, lineEnd, row)) {
+                chunk.errors.push_back(RowError{chunk.lines, p, static_cast<std::size_t>(lineEnd - p), reason});
+            } else {
+                chunk.rows.push_back(row);
+                ++chunk.parsed;
+            }
+        }
+        p = eol + 1;
+    }
+}
+
+} // namespace
+
+template <typename Row, typename ParseRow>
+bool CsvImporter::importFile(const std::string& filename, std::vector<Row>& rows, ParseRow parseRow) {
+    auto start = std::chrono::steady_clock::now();
+    lastStats = CsvImportStats{};
+
+    MappedFile file(filename);
+    if (!file.isOpen()) return false;
+    lastStats.bytes = file.size();
+
+    // Skip the header line.
+    const char* begin = file.data();
+    const char* end = begin + file.size();
+    if (begin) {
+        const char* eol = static_cast<const char*>(std::memchr(begin, '\n', file.size()));
+        begin = eol ? eol + 1 : end;
+    }
+
+    // Cut the rows into chunks that each start right after a newline.
+    std::size_t bytes = static_cast<std::size_t>(end - begin);
+    std::size_t chunkCount = std::max<std::size_t>(1, std::min<std::size_t>(threads, bytes / kMinChunkBytes));
+    std::vector<Chunk<Row>> chunks(chunkCount);
+    const char* cut = begin;
+    for (std::size_t i = 0; i < chunkCount; ++i) {
+        chunks[i].begin = cut;
+        if (i + 1 == chunkCount) {
+            cut = end;
+        } else {
+            const char* target = std::max(cut, begin + bytes / chunkCount * (i + 1));
+            const char* eol = static_cast<const char*>(std::memchr(target, '\n', static_cast<std::size_t>(end - target)));
+            cut = eol ? eol + 1 : end;
+        }
+        chunks[i].end = cut;
+    }
+    // The first chunk parses straight onto the end of the caller's rows.
+    chunks[0].rows.swap(rows);
+    for (auto& chunk : chunks) {
+        chunk.rows.reserve(chunk.rows.size() + static_cast<std::size_t>(chunk.end - chunk.begin) / 24);
+    }
+
+    if (chunkCount == 1) {
+        parseChunk(chunks[0], parseRow);
+    } else {
+        std::vector<std::thread> workers;
+        workers.reserve(chunkCount - 1);
+        for (std::size_t i = 1; i < chunkCount; ++i) {
+            workers.emplace_back([&chunks, &parseRow, i] { parseChunk(chunks[i], parseRow); });
+        }
+        parseChunk(chunks[0], parseRow);
+        for (auto& worker : workers) worker.join();
+    }
+
+    // Join the chunks back in file order, numbering lines from the header (line 1).
+    rows.swap(chunks[0].rows);
+    std::size_t total = rows.size();
+    for (std::size_t i = 1; i < chunkCount; ++i) total += chunks[i].rows.size();
+    rows.reserve(total);
+    std::size_t firstLine = 1;
+    for (std::size_t i = 0; i < chunkCount; ++i) {
+        const auto& chunk = chunks[i];
+        if (i > 0) rows.insert(rows.end(), chunk.rows.begin(), chunk.rows.end());
+        for (const auto& error : chunk.errors) {
+            std::cerr << "Error parsing line " << firstLine + error.line << " in " << filename << ": "
+                      << std::string(error.text, error.length) << " - " << error.reason << std::endl;
+        }
+        lastStats.rows += chunk.parsed;
+        lastStats.rejected += chunk.errors.size();
+        firstLine += chunk.lines;
+    }
+
+    lastStats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+bool CsvImporter::importOrders(const std::string& filename, OrderType type, std::vector<SavedOrder>& orders) {
+    return importFile(filename, orders, OrderRowParser{type});
+}
+
+bool CsvImporter::importTrades(const std::string& filename, std::vector<Trade>& trades) {
+    return importFile(filename, trades, TradeRowParser{});
+}
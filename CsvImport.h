@@ -0,0 +1,50 @@
+#ifndef CSV_IMPORT_H
+#define CSV_IMPORT_H
+
+#include "Order.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// What an import read, for throughput figures and sanity checks.
+struct CsvImportStats {
+    std::size_t bytes = 0;
+    std::size_t rows = 0;     // rows imported
+    std::size_t rejected = 0; // malformed rows skipped
+    double seconds = 0;
+};
+
+// Reads the CSV books (OrderID,Price,Quantity,FilledQuantity,Timestamp) and
+// the trades log (TradeID,BuyOrderID,SellOrderID,Price,Quantity,Timestamp).
+//
+// The file is mapped read-only and each field is parsed in place with
+// std::from_chars, so no line or token is ever copied. With more than one
+// thread the rows are split into chunks at newline boundaries and parsed in
+// parallel; the results are joined back in file order, so the queue order of
+// a saved book is preserved. Malformed rows are reported to stderr with their
+// line number and skipped.
+class CsvImporter {
+public:
+    explicit CsvImporter(unsigned threads = 1) : threads(threads > 0 ? threads : 1) {}
+
+    // Appends the orders saved in filename to orders, all of the given side.
+    // Returns false if the file does not exist.
+    bool importOrders(const std::string& filename, OrderType type, std::vector<SavedOrder>& orders);
+
+    // Appends the trades logged in filename to trades.
+    // Returns false if the file does not exist.
+    bool importTrades(const std::string& filename, std::vector<Trade>& trades);
+
+    // Figures for the most recent import.
+    const CsvImportStats& stats() const { return lastStats; }
+
+private:
+    template <typename Row, typename ParseRow>
+    bool importFile(const std::string& filename, std::vector<Row>& rows, ParseRow parseRow);
+
+    unsigned threads;
+    CsvImportStats lastStats;
+};
+
+#endif // CSV_IMPORT_H
@@ -0,0 +1,37 @@
+#include "DepthSnapshot.h"
+
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+DepthPublisher::DepthPublisher(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) throw std::runtime_error("Failed to create depth segment: " + path);
+    if (::ftruncate(fd, sizeof(DepthSegment)) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Failed to size depth segment: " + path);
+    }
+    void* mapping = ::mmap(nullptr, sizeof(DepthSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) throw std::runtime_error("Failed to map depth segment: " + path);
+
+    segment = new (mapping) DepthSegment();
+    std::memcpy(segment->magic, kDepthMagic, sizeof(kDepthMagic));
+    segment->version = kDepthVersion;
+    segment->levels = kDepthLevels;
+}
+
+DepthPublisher::~DepthPublisher() {
+    if (segment) ::munmap(segment, sizeof(DepthSegment));
+}
+
+void DepthPublisher::publish() {
+    uint64_t sequence = segment->sequence.load(std::memory_order_relaxed);
+    segment->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(&segment->view, &pending, sizeof(pending));
+    segment->sequence.store(sequence + 2, std::memory_order_release);
+}
@@ -0,0 +1,72 @@
+#ifndef DEPTH_SNAPSHOT_H
+#define DEPTH_SNAPSHOT_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Levels published per side.
+constexpr std::size_t kDepthLevels = 10;
+
+// Aggregate of one price level.
+struct DepthLevel {
+    int32_t price;
+    int32_t orders;
+    int64_t quantity; // total remaining quantity at the price
+};
+static_assert(sizeof(DepthLevel) == 16, "DepthLevel is part of the shared-memory layout");
+
+// The book as readers see it. bids[0] and asks[0] are the best bid and offer.
+struct DepthView {
+    uint64_t commands;      // commands applied to the book when this was published
+    int64_t timestamp;      // nanoseconds since the epoch
+    int32_t lastTradePrice; // zero until the first trade
+    int32_t lastTradeQuantity;
+    uint32_t bidLevels;     // valid entries in bids
+    uint32_t askLevels;     // valid entries in asks
+    DepthLevel bids[kDepthLevels];
+    DepthLevel asks[kDepthLevels];
+};
+static_assert(sizeof(DepthView) == 352, "DepthView is part of the shared-memory layout");
+
+// Layout of the mapped file. depth_reader.py decodes the same offsets.
+struct DepthSegment {
+    char magic[8];
+    uint32_t version;
+    uint32_t levels; // kDepthLevels
+    char pad[48];
+    // Seqlock: odd while the writer is updating the view, bumped twice per update.
+    alignas(64) std::atomic<uint64_t> sequence;
+    DepthView view;
+};
+static_assert(offsetof(DepthSegment, sequence) == 64 && offsetof(DepthSegment, view) == 72,
+              "DepthSegment is part of the shared-memory layout");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "The depth seqlock needs lock-free 64-bit atomics");
+
+constexpr char kDepthMagic[8] = {'O', 'M', 'E', 'D', 'E', 'P', 'T', 'H'};
+constexpr uint32_t kDepthVersion = 1;
+
+// Writes the depth view into a shared file under a seqlock. Only the book's
+// matching thread writes; any number of readers in other processes poll it
+// without locks and simply retry if they catch an update in progress.
+class DepthPublisher {
+public:
+    // Creates (or truncates) the segment. Throws std::runtime_error if it cannot.
+    explicit DepthPublisher(const std::string& path);
+    ~DepthPublisher();
+
+    DepthPublisher(const DepthPublisher&) = delete;
+    DepthPublisher& operator=(const DepthPublisher&) = delete;
+
+    // The view to fill in before publish(); it keeps the previous contents.
+    DepthView& view() { return pending; }
+
+    void publish();
+
+private:
+    DepthSegment* segment = nullptr;
+    DepthView pending{};
+};
+
+#endif // DEPTH_SNAPSHOT_H
@@ -0,0 +1,109 @@
+#include "EngineClock.h"
+
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+
+namespace {
+
+Timestamp readNanos(clockid_t id) {
+    timespec ts;
+    clock_gettime(id, &ts);
+    return static_cast<Timestamp>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+// An invariant TSC ticks at a constant rate through frequency changes and
+// sleep states, and in step across cores.
+bool haveInvariantTsc() {
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned eax, ebx, ecx, edx;
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) return false;
+    return (edx & (1u << 8)) != 0;
+#else
+    return false;
+#endif
+}
+
+uint64_t readTsc() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// The tick source and its rate, shared by every clock in the process. The TSC
+// is measured against CLOCK_MONOTONIC_RAW over 10 ms when first needed.
+struct Calibration {
+    bool tsc;
+    uint64_t startTicks;
+    Timestamp startRaw;
+    double nanosPerTick;
+
+    Calibration() : tsc(haveInvariantTsc()) {
+        if (!tsc) {
+            startTicks = 0;
+            startRaw = 0;
+            nanosPerTick = 1.0;
+            return;
+        }
+        startRaw = readNanos(CLOCK_MONOTONIC_RAW);
+        startTicks = readTsc();
+        Timestamp raw;
+        do {
+            raw = readNanos(CLOCK_MONOTONIC_RAW);
+        } while (raw - startRaw < 10000000);
+        uint64_t ticks = readTsc();
+        nanosPerTick = ticks > startTicks ? static_cast<double>(raw - startRaw) / static_cast<double>(ticks - startTicks)
+                                          : 1.0;
+    }
+};
+
+const Calibration& calibration() {
+    static const Calibration shared;
+    return shared;
+}
+
+} // namespace
+
+CalibratedClock::CalibratedClock() {
+    const Calibration& c = calibration();
+    tsc = c.tsc;
+    nanosPerTick = c.nanosPerTick;
+    reanchorTicks = static_cast<uint64_t>(1e9 / nanosPerTick);
+    reanchor();
+}
+
+uint64_t CalibratedClock::readTicks() const {
+    return tsc ? readTsc() : static_cast<uint64_t>(readNanos(CLOCK_MONOTONIC_RAW));
+}
+
+uint64_t CalibratedClock::processTicks() {
+    return calibration().tsc ? readTsc() : static_cast<uint64_t>(readNanos(CLOCK_MONOTONIC_RAW));
+}
+
+double CalibratedClock::processNanosPerTick() {
+    const Calibration& c = calibration();
+    if (!c.tsc) return 1.0;
+    Timestamp raw = readNanos(CLOCK_MONOTONIC_RAW);
+    uint64_t rawTicks = readTsc();
+    if (rawTicks > c.startTicks && raw > c.startRaw) {
+        return static_cast<double>(raw - c.startRaw) / static_cast<double>(rawTicks - c.startTicks);
+    }
+    return c.nanosPerTick;
+}
+
+// Pins the tick count to wall time again and, for the TSC, re-measures its rate
+// over everything since the process calibrated it.
+void CalibratedClock::reanchor() {
+    if (tsc) nanosPerTick = processNanosPerTick();
+    // Take the wall time between two tick readings and pair it with their midpoint.
+    uint64_t before = readTicks();
+    Timestamp wall = readNanos(CLOCK_REALTIME);
+    uint64_t after = readTicks();
+    anchorTicks = before + (after - before) / 2;
+    anchorNanos = wall;
+}
@@ -0,0 +1,83 @@
+#ifndef ENGINE_CLOCK_H
+#define ENGINE_CLOCK_H
+
+#include "Order.h"
+
+#include <cstdint>
+
+// Where an OrderBook's timestamps come from. The book reads its clock once per
+// inbound command and stamps everything that command produces (the order, its
+// trades, journal records, structured log events, market data and depth) with
+// that one reading. A clock is read from one thread at a time.
+class EngineClock {
+public:
+    virtual ~EngineClock() = default;
+
+    // Nanoseconds since the Unix epoch.
+    virtual Timestamp now() = 0;
+};
+
+// Wall-clock nanoseconds without a system call per reading. Counts the TSC
+// when the CPU has an invariant one, and CLOCK_MONOTONIC_RAW otherwise, from
+// an anchor taken against CLOCK_REALTIME. The tick rate is measured once per
+// process against CLOCK_MONOTONIC_RAW; each clock re-anchors itself about once
+// a second, refining the rate over the longer span, so it does not drift from
+// wall time. Readings never go backwards.
+class CalibratedClock : public EngineClock {
+public:
+    CalibratedClock();
+
+    Timestamp now() override {
+        uint64_t ticks = readTicks();
+        if (ticks - anchorTicks >= reanchorTicks) reanchor();
+        // Signed: a new anchor may sit a few ticks after this reading.
+        auto elapsed = static_cast<int64_t>(ticks - anchorTicks);
+        Timestamp t = anchorNanos + static_cast<Timestamp>(static_cast<double>(elapsed) * nanosPerTick);
+        if (t < last) t = last;
+        last = t;
+        return t;
+    }
+
+    // Whether the clock counts the TSC rather than CLOCK_MONOTONIC_RAW.
+    bool usesTsc() const { return tsc; }
+
+    // The tick source every CalibratedClock in the process counts, for timing
+    // intervals that are only turned into nanoseconds later (see EngineStats).
+    static uint64_t processTicks();
+    // Nanoseconds per processTicks() tick, measured over everything since the
+    // process calibrated, so it sharpens the longer the process runs.
+    static double processNanosPerTick();
+
+private:
+    uint64_t readTicks() const;
+    void reanchor();
+
+    bool tsc;
+    double nanosPerTick;
+    uint64_t reanchorTicks; // about one second of ticks
+    uint64_t anchorTicks = 0;
+    Timestamp anchorNanos = 0;
+    Timestamp last = 0;
+};
+
+// Deterministic time for replays and tests: starts at `start` and moves on by
+// `step` after every reading, unless it is set explicitly.
+class FakeClock : public EngineClock {
+public:
+    explicit FakeClock(Timestamp start = 0, Timestamp step = 0) : current(start), step(step) {}
+
+    Timestamp now() override {
+        Timestamp t = current;
+        current += step;
+        return t;
+    }
+
+    // The next reading returns exactly this.
+    void set(Timestamp t) { current = t; }
+
+private:
+    Timestamp current;
+    Timestamp step;
+};
+
+#endif // ENGINE_CLOCK_H
@@ -0,0 +1,70 @@
+#include "EngineStats.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+const char* stageName(Stage stage) {
+    switch (stage) {
+        case Stage::PLACE: return "place";
+        case Stage::PLACE_MATCH: return "place.match";
+        case Stage::PLACE_PERSIST: return "place.persist";
+        case Stage::PLACE_LOG: return "place.log";
+        case Stage::CANCEL: return "cancel";
+        case Stage::CANCEL_PERSIST: return "cancel.persist";
+        case Stage::CANCEL_LOG: return "cancel.log";
+        case Stage::MODIFY: return "modify";
+        case Stage::MASS_CANCEL: return "mass_cancel";
+        case Stage::EXPORT: return "export";
+        case Stage::SNAPSHOT: return "snapshot";
+        default: return "unknown";
+    }
+}
+
+uint64_t LatencyHistogram::percentile(double fraction) const {
+    if (total == 0) return 0;
+    uint64_t rank = static_cast<uint64_t>(fraction * static_cast<double>(total) + 0.999999);
+    if (rank == 0) rank = 1;
+    uint64_t seen = 0;
+    for (std::size_t i = 0; i < kBuckets; ++i) {
+        seen += counts[i];
+        if (seen >= rank) return std::min(upperEdge(i), maxValue);
+    }
+    return maxValue;
+}
+
+#if OME_STATS
+
+void EngineStats::print(std::ostream& out) const {
+    double scale = CalibratedClock::processNanosPerTick();
+    auto ns = [scale](uint64_t ticks) { return static_cast<uint64_t>(static_cast<double>(ticks) * scale); };
+
+    out << "Orders: " << orders << ", trades: " << trades << ", cancels: " << cancels << ", modifies: " << modifies
+        << ", rejected: " << rejects
+        << "\n"
+        << std::left << std::setw(16) << "Stage (ns)" << std::right << std::setw(10) << "count" << std::setw(10)
+        << "p50" << std::setw(10) << "p99" << std::setw(10) << "p99.9" << std::setw(12) << "max" << "\n";
+    for (std::size_t i = 0; i < histograms.size(); ++i) {
+        const LatencyHistogram& h = histograms[i];
+        if (h.count() == 0) continue;
+        out << std::left << std::setw(16) << stageName(static_cast<Stage>(i)) << std::right << std::setw(10)
+            << h.count() << std::setw(10) << ns(h.percentile(0.50)) << std::setw(10) << ns(h.percentile(0.99))
+            << std::setw(10) << ns(h.percentile(0.999)) << std::setw(12) << ns(h.max()) << "\n";
+    }
+    out.flush();
+}
+
+bool EngineStats::dump(const std::string& path) const {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) return false;
+    print(out);
+    return static_cast<bool>(out);
+}
+
+#else
+
+void EngineStats::print(std::ostream& out) const {
+    out << "Statistics were compiled out (built with OME_STATS=0)." << std::endl;
+}
+
+#endif
@@ -0,0 +1,138 @@
+#ifndef ENGINE_STATS_H
+#define ENGINE_STATS_H
+
+#include "EngineClock.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+// Per-stage latency statistics are compiled in unless OME_STATS is 0, in which
+// case EngineStats keeps no state and every call compiles to nothing.
+#ifndef OME_STATS
+#define OME_STATS 1
+#endif
+constexpr bool kStatsEnabled = OME_STATS != 0;
+
+// The stages of placeOrder and cancelOrder that are timed separately.
+// "persist" covers the journal and trades.csv, "log" the structured log events
+// and market data (and releasing what the command filled or cancelled).
+enum class Stage : uint8_t {
+    PLACE,          // placeOrder end to end
+    PLACE_MATCH,    // matching, with each fill logged, published and recorded inline, and resting what is left
+    PLACE_PERSIST,  // committing trades.csv and the journal
+    PLACE_LOG,      // the book changes that follow the match
+    CANCEL,         // cancelOrder end to end
+    CANCEL_PERSIST,
+    CANCEL_LOG,
+    MODIFY,         // modifyOrder end to end
+    MASS_CANCEL,    // massCancel end to end
+    EXPORT,         // exportActiveOrders
+    SNAPSHOT,
+    COUNT
+};
+
+const char* stageName(Stage stage);
+
+// A log-linear histogram in the style of HdrHistogram: values below 32 are
+// counted exactly, and every power of two above that is split into 32 equal
+// buckets, so any reported value is within about 3% of the true one. Fixed
+// size, no allocation, and recording is an index computation and an increment.
+class LatencyHistogram {
+public:
+    void record(uint64_t value) {
+        ++counts[indexOf(value)];
+        ++total;
+        if (value > maxValue) maxValue = value;
+    }
+
+    uint64_t count() const { return total; }
+    uint64_t max() const { return maxValue; }
+
+    // The smallest recorded value that at least this fraction of the samples
+    // are at or below, rounded up to its bucket's upper edge.
+    uint64_t percentile(double fraction) const;
+
+private:
+    static constexpr int kSubBits = 5;
+    static constexpr uint64_t kSubBuckets = uint64_t(1) << kSubBits;
+    static constexpr int kMaxBits = 48; // larger values land in the last bucket
+    static constexpr std::size_t kBuckets = (kMaxBits - kSubBits + 1) * kSubBuckets;
+
+    static std::size_t indexOf(uint64_t value) {
+        if (value < kSubBuckets) return static_cast<std::size_t>(value);
+        int msb = 63 - __builtin_clzll(value);
+        if (msb >= kMaxBits) return kBuckets - 1;
+        int shift = msb - kSubBits;
+        return static_cast<std::size_t>((shift + 1) * kSubBuckets + ((value >> shift) - kSubBuckets));
+    }
+
+    static uint64_t upperEdge(std::size_t index) {
+        if (index < kSubBuckets) return index;
+        int shift = static_cast<int>(index / kSubBuckets) - 1;
+        uint64_t sub = index % kSubBuckets + kSubBuckets;
+        return ((sub + 1) << shift) - 1;
+    }
+
+    std::array<uint64_t, kBuckets> counts{};
+    uint64_t total = 0;
+    uint64_t maxValue = 0;
+};
+
+#if OME_STATS
+
+// Counters and stage histograms for one OrderBook. Durations are recorded in
+// the process tick of CalibratedClock (the TSC when it is invariant) so the hot
+// path never converts; ticks are turned into nanoseconds with the clock's
+// calibration only when the stats are printed. Like the book, it is used from
+// one thread at a time.
+class EngineStats {
+public:
+    using Ticks = uint64_t;
+
+    static Ticks now() { return CalibratedClock::processTicks(); }
+
+    void record(Stage stage, Ticks ticks) { histograms[static_cast<std::size_t>(stage)].record(ticks); }
+
+    void countOrder() { ++orders; }
+    void countTrades(uint64_t n) { trades += n; }
+    void countCancel(uint64_t n = 1) { cancels += n; }
+    void countModify() { ++modifies; }
+    void countReject() { ++rejects; }
+
+    // Prints the counters and p50/p99/p99.9/max of every stage, in nanoseconds.
+    void print(std::ostream& out) const;
+
+    // Writes the same report to a file. Returns false if it cannot be written.
+    bool dump(const std::string& path) const;
+
+private:
+    std::array<LatencyHistogram, static_cast<std::size_t>(Stage::COUNT)> histograms;
+    uint64_t orders = 0;
+    uint64_t trades = 0;
+    uint64_t cancels = 0;
+    uint64_t modifies = 0;
+    uint64_t rejects = 0;
+};
+
+#else
+
+class EngineStats {
+public:
+    using Ticks = uint64_t;
+    static Ticks now() { return 0; }
+    void record(Stage, Ticks) {}
+    void countOrder() {}
+    void countTrades(uint64_t) {}
+    void countCancel(uint64_t = 1) {}
+    void countModify() {}
+    void countReject() {}
+    void print(std::ostream& out) const;
+    bool dump(const std::string&) const { return true; }
+};
+
+#endif
+
+#endif // ENGINE_STATS_H
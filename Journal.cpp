@@ -0,0 +1,191 @@
+#include "Journal.h"
+#include "OrderPool.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+
+constexpr char Journal::kMagic[8];
+
+Journal::Journal(const std::string& path, TradeDurability durability) : path(path), durability(durability) {
+    std::error_code ec;
+    auto size = std::filesystem::file_size(path, ec);
+    bool fresh = ec || size == 0;
+
+    if (!fresh) {
+        std::ifstream in(path, std::ios::binary);
+        char magic[8];
+        uint32_t version = 0;
+        uint32_t reserved = 0;
+        in.read(magic, sizeof(magic));
+        in.read(reinterpret_cast<char*>(&version), sizeof(version));
+        in.read(reinterpret_cast<char*>(&reserved), sizeof(reserved));
+        if (!in || std::memcmp(magic, kMagic, sizeof(magic)) != 0 || version != kVersion) {
+            throw std::runtime_error("Not a supported order journal: " + path);
+        }
+        in.read(reinterpret_cast<char*>(&base), sizeof(base));
+        if (!in) throw std::runtime_error("Truncated order journal header: " + path);
+
+        existingRecords = (size - kHeaderSize) / sizeof(JournalRecord);
+        auto complete = kHeaderSize + existingRecords * sizeof(JournalRecord);
+        if (complete != size) {
+            // The last write was interrupted; drop the partial record.
+            std::filesystem::resize_file(path, complete);
+        }
+    }
+
+    // A raw descriptor so that each commit is exactly one write() and can be fdatasync'd.
+    openFile(O_WRONLY | O_APPEND | O_CREAT);
+    if (fresh) writeHeader();
+}
+
+Journal::~Journal() {
+    if (!pending.empty()) commit();
+    if (fd >= 0) ::close(fd);
+}
+
+void Journal::openFile(int flags) {
+    fd = ::open(path.c_str(), flags, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open order journal " + path + ": " + std::strerror(errno));
+    }
+}
+
+void Journal::writeHeader() {
+    char header[kHeaderSize] = {};
+    std::memcpy(header, kMagic, sizeof(kMagic));
+    std::memcpy(header + sizeof(kMagic), &kVersion, sizeof(kVersion));
+    std::memcpy(header + 16, &base, sizeof(base));
+    pending.insert(pending.end(), header, header + sizeof(header));
+    if (!commit()) throw std::runtime_error("Failed to write order journal header: " + path);
+}
+
+void Journal::reset(uint64_t baseSequence) {
+    ::close(fd);
+    fd = -1;
+    pending.clear();
+    openFile(O_WRONLY | O_APPEND | O_CREAT | O_TRUNC);
+    base = baseSequence;
+    existingRecords = 0;
+    appended = 0;
+    writeHeader();
+}
+
+void Journal::replay(uint64_t fromSequence, const std::function<void(const JournalRecord&)>& apply) const {
+    std::size_t skip = fromSequence > base ? static_cast<std::size_t>(fromSequence - base) : 0;
+    if (skip >= existingRecords) return;
+
+    std::ifstream in(path, std::ios::binary);
+    in.seekg(static_cast<std::streamoff>(kHeaderSize + skip * sizeof(JournalRecord)));
+
+    std::vector<JournalRecord> chunk(4096);
+    std::size_t remaining = existingRecords - skip;
+    while (remaining > 0 && in) {
+        std::size_t n = std::min(remaining, chunk.size());
+        in.read(reinterpret_cast<char*>(chunk.data()), n * sizeof(JournalRecord));
+        n = static_cast<std::size_t>(in.gcount()) / sizeof(JournalRecord);
+        for (std::size_t i = 0; i < n; ++i) apply(chunk[i]);
+        remaining -= n;
+    }
+}
+
+void Journal::recordNew(const Order& order) {
+    JournalRecord record{};
+    record.type = static_cast<uint32_t>(JournalEventType::NEW);
+    record.side = static_cast<uint32_t>(order.type);
+    record.orderId = order.id;
+    record.otherId = OrderPool::info(&order).owner;
+    record.price = order.price;
+    record.quantity = order.quantity;
+    record.filled = order.filled_quantity;
+    record.timestamp = OrderPool::info(&order).timestamp;
+    append(record);
+}
+
+void Journal::recordFill(const Trade& trade) {
+    JournalRecord record{};
+    record.type = static_cast<uint32_t>(JournalEventType::FILL);
+    record.orderId = trade.buyOrderId;
+    record.otherId = trade.sellOrderId;
+    record.price = trade.price;
+    record.quantity = trade.quantity;
+    record.tradeId = trade.tradeId;
+    record.timestamp = trade.timestamp;
+    append(record);
+}
+
+void Journal::recordCancel(OrderId orderId, Timestamp timestamp) {
+    JournalRecord record{};
+    record.type = static_cast<uint32_t>(JournalEventType::CANCEL);
+    record.orderId = orderId;
+    record.timestamp = timestamp;
+    append(record);
+}
+
+void Journal::recordModify(const Order& order) {
+    JournalRecord record{};
+    record.type = static_cast<uint32_t>(JournalEventType::MODIFY);
+    record.side = static_cast<uint32_t>(order.type);
+    record.orderId = order.id;
+    record.price = order.price;
+    record.quantity = order.quantity;
+    record.timestamp = OrderPool::info(&order).timestamp;
+    append(record);
+}
+
+void Journal::recordMassCancel(const MassCancelFilter& filter, Timestamp timestamp) {
+    JournalRecord record{};
+    record.type = static_cast<uint32_t>(JournalEventType::MASS_CANCEL);
+    record.side = filter.side ? static_cast<uint32_t>(*filter.side) : kJournalBothSides;
+    record.otherId = filter.owner;
+    record.price = filter.minPrice;
+    record.quantity = filter.maxPrice;
+    record.timestamp = timestamp;
+    append(record);
+}
+
+void Journal::recordOrderId(OrderId orderId, Timestamp timestamp) {
+    JournalRecord record{};
+    record.type = static_cast<uint32_t>(JournalEventType::ORDER_ID);
+    record.orderId = orderId;
+    record.timestamp = timestamp;
+    append(record);
+}
+
+void Journal::append(const JournalRecord& record) {
+    // Records collect in memory until commit().
+    const char* bytes = reinterpret_cast<const char*>(&record);
+    pending.insert(pending.end(), bytes, bytes + sizeof(record));
+    ++appended;
+}
+
+bool Journal::commit() {
+    const char* data = pending.data();
+    std::size_t left = pending.size();
+    while (left > 0) {
+        ssize_t written = ::write(fd, data, left);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "Error writing " << path << ": " << std::strerror(errno) << std::endl;
+            ++writeFailureCount;
+            pending.erase(pending.begin(), pending.begin() + (data - pending.data()));
+            return false;
+        }
+        data += written;
+        left -= static_cast<std::size_t>(written);
+    }
+    bool synced = true;
+    if (durability == TradeDurability::FDATASYNC && !pending.empty() && ::fdatasync(fd) != 0) {
+        std::cerr << "Error syncing " << path << ": " << std::strerror(errno) << std::endl;
+        ++syncFailureCount;
+        synced = false;
+    }
+    pending.clear();
+    return synced;
+}
@@ -0,0 +1,113 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include "Order.h"
+#include "Persistence.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Kinds of events recorded in the order journal.
+enum class JournalEventType : uint32_t { NEW = 1, FILL = 2, CANCEL = 3, MODIFY = 4, MASS_CANCEL = 5, ORDER_ID = 6 };
+
+// MASS_CANCEL side value for a cancel that covers both sides.
+constexpr uint32_t kJournalBothSides = 2;
+
+// One fixed-size journal entry. Fields that an event type does not use are zero.
+struct JournalRecord {
+    uint32_t type;      // JournalEventType
+    uint32_t side;      // NEW/MODIFY: OrderType of the order; MASS_CANCEL: OrderType or kJournalBothSides
+    int64_t orderId;    // NEW/CANCEL/MODIFY/ORDER_ID: the order; FILL: the buy order
+    int64_t otherId;    // NEW: the order's owner; FILL: the sell order; MASS_CANCEL: owner filter
+    int64_t tradeId;    // FILL: trade id
+    int32_t price;      // NEW/MODIFY: limit price; FILL: execution price; MASS_CANCEL: lowest price
+    int32_t quantity;   // NEW/MODIFY: order quantity; FILL: traded quantity; MASS_CANCEL: highest price
+    int32_t filled;     // NEW: quantity already filled when the order was journaled
+    uint32_t reserved;
+    int64_t timestamp;  // nanoseconds since the epoch
+};
+static_assert(sizeof(JournalRecord) == 56, "JournalRecord is part of the on-disk format");
+
+// Append-only binary log of every change to the book. Each operation appends a
+// handful of fixed-size records and commits them with one write, so the cost
+// does not depend on how many orders are resting. Replaying the journal on top
+// of the snapshot it follows rebuilds the book exactly.
+//
+// Every record has a sequence number: the journal's base sequence plus its
+// position in the file. After a snapshot the journal is reset to start at the
+// snapshot's sequence, so recovery only replays the tail written since.
+//
+// The journal is the source of truth, so every commit reaches the OS whatever
+// the durability: NONE is treated as FLUSH. With FDATASYNC each commit is also
+// fdatasync'd, as trades.csv batches are.
+class Journal {
+public:
+    // Opens (or creates) the journal file. A torn record left by a crash is discarded.
+    explicit Journal(const std::string& path, TradeDurability durability = TradeDurability::FLUSH);
+    // Commits any records still pending.
+    ~Journal();
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    // Number of complete records in the journal when it was opened.
+    std::size_t recordCount() const { return existingRecords; }
+
+    // Sequence number of the first record in the file.
+    uint64_t baseSequence() const { return base; }
+
+    // Sequence number the next appended record will get.
+    uint64_t nextSequence() const { return base + existingRecords + appended; }
+
+    // Feeds every record with a sequence number of at least fromSequence, oldest first, to apply.
+    void replay(uint64_t fromSequence, const std::function<void(const JournalRecord&)>& apply) const;
+
+    // Orders passed to recordNew and recordModify must be pooled: their timestamp
+    // and owner are read from OrderInfo.
+    void recordNew(const Order& order);
+    void recordFill(const Trade& trade);
+    void recordCancel(OrderId orderId, Timestamp timestamp);
+    // An order's new price and total quantity, ahead of any fills the change causes.
+    void recordModify(const Order& order);
+    // The filter of a mass cancel. Replaying it against the same book removes the same orders.
+    void recordMassCancel(const MassCancelFilter& filter, Timestamp timestamp);
+    // An order id that no other record carries (an order that neither rested nor
+    // traded), so that recovery does not hand it out again.
+    void recordOrderId(OrderId orderId, Timestamp timestamp);
+
+    // Writes the records appended since the last commit with a single write()
+    // and, with FDATASYNC, syncs them. Returns false if they did not reach the
+    // disk: on a write error the unwritten bytes stay pending for the next commit.
+    bool commit();
+
+    uint64_t writeFailures() const { return writeFailureCount; }
+    uint64_t syncFailures() const { return syncFailureCount; }
+
+    // Discards every record and starts an empty journal at baseSequence.
+    // Only call this once a snapshot covering those records is safely on disk.
+    void reset(uint64_t baseSequence);
+
+private:
+    static constexpr char kMagic[8] = {'O', 'M', 'E', 'J', 'R', 'N', 'L', '1'};
+    static constexpr uint32_t kVersion = 3;
+    static constexpr std::size_t kHeaderSize = 24;
+
+    std::string path;
+    TradeDurability durability;
+    int fd = -1;
+    std::vector<char> pending; // records appended since the last commit
+    uint64_t base = 0;
+    std::size_t existingRecords = 0;
+    std::size_t appended = 0;
+    uint64_t writeFailureCount = 0;
+    uint64_t syncFailureCount = 0;
+
+    void openFile(int flags);
+    void writeHeader();
+    void append(const JournalRecord& record);
+};
+
+#endif // JOURNAL_H
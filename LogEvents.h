@@ -0,0 +1,96 @@
+#ifndef LOG_EVENTS_H
+#define LOG_EVENTS_H
+
+#include "Order.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Severity of a structured log event. Events below OME_LOG_LEVEL are compiled out.
+enum class LogLevel : int { DEBUG = 0, INFO = 1, ERROR = 2 };
+
+#ifndef OME_LOG_LEVEL
+#define OME_LOG_LEVEL 0
+#endif
+constexpr LogLevel kCompiledLogLevel = static_cast<LogLevel>(OME_LOG_LEVEL);
+
+// Identifiers of the structured events. The values are stored in events.bin,
+// so only ever append to this list.
+enum class LogEvent : uint16_t {
+    ORDER_PLACED,    // side, order id, quantity, price
+    TRADE_MATCHED,   // quantity, price, buy order id, sell order id
+    ORDER_FILLED,    // side, order id
+    ORDER_CANCELLED, // order id
+    ORDER_EXPIRED,   // side, order id, unfilled quantity (IOC and market remainders)
+    ORDER_KILLED,    // side, quantity, price (fill-or-kill orders that could not fill)
+    ORDER_MODIFIED,  // side, order id, new quantity, new price
+    MASS_CANCELLED,  // orders cancelled, owner, lowest price, highest price
+    COUNT
+};
+
+struct LogEventInfo {
+    LogLevel level;
+    const char* category;
+    // "{}" is replaced by the next argument as a number, "{side}" by BUY/SELL
+    // and "{Side}" by Buy/Sell.
+    const char* format;
+};
+
+constexpr LogEventInfo kLogEvents[] = {
+    {LogLevel::DEBUG, "Order", "Placing {side} order ID {} for {} @ {}"},
+    {LogLevel::DEBUG, "Trade", "Matched {} units at price {} (Buy:{} Sell:{})"},
+    {LogLevel::DEBUG, "Order", "{Side} order {} is fully FILLED."},
+    {LogLevel::DEBUG, "Order", "Cancelled order ID {}"},
+    {LogLevel::DEBUG, "Order", "{Side} order {} expired with {} unfilled"},
+    {LogLevel::DEBUG, "Order", "Killed {side} fill-or-kill order for {} @ {}: not enough liquidity"},
+    {LogLevel::DEBUG, "Order", "Modified {side} order ID {} to {} @ {}"},
+    {LogLevel::DEBUG, "Order", "Mass cancel removed {} orders (owner {}, prices {}-{})"},
+};
+static_assert(sizeof(kLogEvents) / sizeof(kLogEvents[0]) == static_cast<std::size_t>(LogEvent::COUNT),
+              "Every LogEvent needs an entry in kLogEvents");
+
+constexpr LogLevel logEventLevel(LogEvent event) { return kLogEvents[static_cast<std::size_t>(event)].level; }
+
+// One event as stored in events.bin: the id plus raw arguments, unformatted.
+struct BinaryLogRecord {
+    int64_t timestamp; // nanoseconds since the epoch
+    uint16_t event;
+    uint16_t argCount;
+    uint32_t reserved;
+    int64_t args[4];
+};
+static_assert(sizeof(BinaryLogRecord) == 48, "BinaryLogRecord is part of the on-disk format");
+
+constexpr char kBinaryLogMagic[8] = {'O', 'M', 'E', 'L', 'O', 'G', '0', '1'};
+
+// Renders a structured event as the message text the plain logger would have written.
+inline std::string formatLogEvent(const BinaryLogRecord& record) {
+    if (record.event >= static_cast<uint16_t>(LogEvent::COUNT)) {
+        return "Unknown event " + std::to_string(record.event);
+    }
+    std::string out;
+    std::size_t next = 0;
+    for (const char* p = kLogEvents[record.event].format; *p; ++p) {
+        if (*p != '{') {
+            out += *p;
+            continue;
+        }
+        std::string spec;
+        for (++p; *p && *p != '}'; ++p) spec += *p;
+        if (!*p) break;
+        int64_t value = next < record.argCount ? record.args[next] : 0;
+        ++next;
+        OrderType side = value == static_cast<int64_t>(OrderType::BUY) ? OrderType::BUY : OrderType::SELL;
+        if (spec == "side") {
+            out += typeToStr(side);
+        } else if (spec == "Side") {
+            out += side == OrderType::BUY ? "Buy" : "Sell";
+        } else {
+            out += std::to_string(value);
+        }
+    }
+    return out;
+}
+
+#endif // LOG_EVENTS_H
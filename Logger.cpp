@@ -1,31 +1,208 @@
 #include "Logger.h"
+#include <algorithm>
+#include <cstring>
+#include <ctime>
 
 // Constructor: Initializes the logger and opens the specified file.
-Logger::Logger(const std::string& log_file) {
+Logger::Logger(const std::string& log_file, const LoggerOptions& options) : options(options) {
     eventLog.open(log_file, std::ios::app);
     if (!eventLog.is_open()) {
         throw std::runtime_error("Failed to open log file: " + log_file);
     }
+
+    if (!options.binaryLogFile.empty()) {
+        binaryLog.open(options.binaryLogFile, std::ios::binary | std::ios::app);
+        if (!binaryLog.is_open()) {
+            throw std::runtime_error("Failed to open binary log file: " + options.binaryLogFile);
+        }
+        if (binaryLog.tellp() == 0) {
+            binaryLog.write(kBinaryLogMagic, sizeof(kBinaryLogMagic));
+        }
+    }
+
+    if (options.async) {
+        std::size_t capacity = 2;
+        while (capacity < options.queueCapacity) capacity <<= 1;
+        ring.reset(new Record[capacity]);
+        ringMask = capacity - 1;
+        writer = std::thread(&Logger::runWriter, this);
+    }
     log("System", "Logger initialized.");
 }
 
-// Destructor: Logs a shutdown message and closes the file.
+// Destructor: Logs a shutdown message, drains the queue and closes the file.
 Logger::~Logger() {
     log("System", "Logger shutting down.");
+    if (writer.joinable()) {
+        stopping.store(true, std::memory_order_release);
+        wake.notify_one();
+        writer.join();
+        if (droppedCount() > 0) {
+            std::string note = "Dropped " + std::to_string(droppedCount()) + " log messages (queue full).";
+            write(getCurrentTimestamp(), "System", note.c_str(), note.size());
+        }
+    }
     if (eventLog.is_open()) {
         eventLog.close();
     }
+    if (binaryLog.is_open()) {
+        binaryLog.close();
+    }
 }
 
-// Logs a formatted message to the file.
+// Logs a formatted message to the file, or queues it for the writer thread.
 void Logger::log(const std::string& category, const std::string& message) {
-    time_t now = getCurrentTimestamp();
-    // Using std::put_time for safe, formatted time output.
-    eventLog << std::put_time(std::localtime(&now), "%Y-%m-%d %H:%M:%S")
-             << " [" << category << "] " << message << "\n";
+    if (options.async) {
+        Record record;
+        record.timestamp = getCurrentTimestamp();
+        record.binary = false;
+        std::size_t catLen = std::min(category.size(), sizeof(record.category) - 1);
+        std::memcpy(record.category, category.data(), catLen);
+        record.category[catLen] = '\0';
+        record.length = static_cast<uint32_t>(std::min(message.size(), sizeof(record.message)));
+        std::memcpy(record.message, message.data(), record.length);
+        enqueue(record);
+        return;
+    }
+    write(getCurrentTimestamp(), category.c_str(), message.data(), message.size());
     eventLog.flush(); // Ensure the message is written immediately.
 }
 
+void Logger::logEvent(const BinaryLogRecord& event) {
+    static_assert(sizeof(BinaryLogRecord) <= sizeof(Record::message), "Binary events must fit in a ring slot");
+    if (options.async) {
+        Record record;
+        record.timestamp = static_cast<time_t>(event.timestamp / 1000000000);
+        record.binary = true;
+        record.length = sizeof(event);
+        std::memcpy(record.message, &event, sizeof(event));
+        enqueue(record);
+        return;
+    }
+    if (binaryLog.is_open()) {
+        // Left in the stream buffer; it reaches the file when the buffer fills or the logger closes.
+        binaryLog.write(reinterpret_cast<const char*>(&event), sizeof(event));
+    } else {
+        std::string message = formatLogEvent(event);
+        write(static_cast<time_t>(event.timestamp / 1000000000), kLogEvents[event.event].category, message.data(),
+              message.size());
+        eventLog.flush();
+    }
+}
+
+void Logger::writeRecord(const Record& record) {
+    if (!record.binary) {
+        write(record.timestamp, record.category, record.message, record.length);
+        return;
+    }
+    BinaryLogRecord event;
+    std::memcpy(&event, record.message, sizeof(event));
+    if (binaryLog.is_open()) {
+        binaryLog.write(reinterpret_cast<const char*>(&event), sizeof(event));
+    } else {
+        std::string message = formatLogEvent(event);
+        write(static_cast<time_t>(event.timestamp / 1000000000), kLogEvents[event.event].category, message.data(),
+              message.size());
+    }
+}
+
+void Logger::write(time_t timestamp, const char* category, const char* message, std::size_t length) {
+    // localtime/strftime only run once per second of log output. localtime_r
+    // because several loggers may be writing from different threads.
+    if (timestamp != cachedSecond) {
+        std::tm local;
+        localtime_r(&timestamp, &local);
+        std::strftime(cachedStamp, sizeof(cachedStamp), "%Y-%m-%d %H:%M:%S", &local);
+        cachedSecond = timestamp;
+    }
+    eventLog << cachedStamp << " [" << category << "] ";
+    eventLog.write(message, static_cast<std::streamsize>(length));
+    eventLog << "\n";
+}
+
+void Logger::enqueue(const Record& record) {
+    // Once spilling has started, keep spilling until the writer catches up so
+    // that messages stay in order.
+    if (spilling.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(spillMutex);
+        if (spilling.load(std::memory_order_relaxed)) {
+            spill.push_back(record);
+            return;
+        }
+    }
+
+    std::size_t h = head.load(std::memory_order_relaxed);
+    while (h - tail.load(std::memory_order_acquire) > ringMask) {
+        switch (options.overflow) {
+            case LogOverflowPolicy::DROP:
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            case LogOverflowPolicy::SPILL: {
+                std::lock_guard<std::mutex> lock(spillMutex);
+                spill.push_back(record);
+                spilling.store(true, std::memory_order_release);
+                return;
+            }
+            case LogOverflowPolicy::BLOCK:
+                wake.notify_one();
+                std::this_thread::yield();
+                break;
+        }
+    }
+
+    ring[h & ringMask] = record;
+    head.store(h + 1, std::memory_order_release);
+}
+
+// Writes everything queued so far. Returns false if there was nothing to write.
+bool Logger::drainBatch() {
+    auto drainRing = [this]() {
+        std::size_t t = tail.load(std::memory_order_relaxed);
+        std::size_t h = head.load(std::memory_order_acquire);
+        bool any = t != h;
+        for (; t != h; ++t) {
+            writeRecord(ring[t & ringMask]);
+        }
+        tail.store(t, std::memory_order_release);
+        return any;
+    };
+
+    bool wrote = drainRing();
+
+    if (spilling.load(std::memory_order_acquire)) {
+        // The producer stops using the ring while it spills, so after one more
+        // drain everything left in the spill list is newer than the ring.
+        wrote = drainRing() || wrote;
+        std::vector<Record> spilled;
+        {
+            std::lock_guard<std::mutex> lock(spillMutex);
+            spilled.swap(spill);
+            spilling.store(false, std::memory_order_release);
+        }
+        for (const Record& record : spilled) {
+            writeRecord(record);
+        }
+        wrote = wrote || !spilled.empty();
+    }
+
+    if (wrote) {
+        eventLog.flush();
+        if (binaryLog.is_open()) binaryLog.flush();
+    }
+    return wrote;
+}
+
+void Logger::runWriter() {
+    while (!stopping.load(std::memory_order_acquire)) {
+        if (!drainBatch()) {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wake.wait_for(lock, std::chrono::milliseconds(2));
+        }
+    }
+    // Shutting down: the producer has stopped, so one more pass empties the queue.
+    drainBatch();
+}
+
 // Helper function to get the current time.
 time_t Logger::getCurrentTimestamp() const {
     return std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
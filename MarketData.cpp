@@ -0,0 +1,140 @@
+#include "MarketData.h"
+
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+std::size_t roundUpToPowerOfTwo(std::size_t n) {
+    std::size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+// Maps `size` bytes of an open file shared, closing the descriptor either way.
+void* mapShared(int fd, std::size_t size, int protection, const std::string& path) {
+    void* mapping = ::mmap(nullptr, size, protection, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) throw std::runtime_error("Failed to map market data feed: " + path);
+    return mapping;
+}
+
+} // namespace
+
+MarketDataFeed::MarketDataFeed(const std::string& path, std::size_t capacity) : path(path) {
+    std::size_t slotCount = roundUpToPowerOfTwo(capacity > 0 ? capacity : 1);
+    mappedSize = sizeof(MarketDataHeader) + slotCount * sizeof(MarketDataSlot);
+
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) throw std::runtime_error("Failed to create market data feed: " + path);
+    if (::ftruncate(fd, static_cast<off_t>(mappedSize)) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Failed to size market data feed: " + path);
+    }
+    void* mapping = mapShared(fd, mappedSize, PROT_READ | PROT_WRITE, path);
+
+    // The file starts zeroed, so every slot reads as "being written" until it is filled.
+    header = new (mapping) MarketDataHeader();
+    std::memcpy(header->magic, kMarketDataMagic, sizeof(kMarketDataMagic));
+    header->version = kMarketDataVersion;
+    header->eventSize = sizeof(MarketDataEvent);
+    header->capacity = slotCount;
+    slots = reinterpret_cast<MarketDataSlot*>(static_cast<char*>(mapping) + sizeof(MarketDataHeader));
+    mask = slotCount - 1;
+    refreshesServed = header->refreshRequests.load(std::memory_order_relaxed);
+}
+
+MarketDataFeed::~MarketDataFeed() {
+    if (header) ::munmap(header, mappedSize);
+}
+
+void MarketDataFeed::publish(MarketDataEventType type, OrderType side, int price, OrderId orderId, int quantity,
+                             int64_t otherId, int64_t tradeId) {
+    MarketDataEvent event{};
+    event.timestamp = timestamp;
+    event.type = static_cast<uint16_t>(type);
+    event.side = static_cast<uint16_t>(side);
+    event.price = price;
+    event.orderId = orderId;
+    event.quantity = quantity;
+    event.otherId = otherId;
+    event.tradeId = tradeId;
+
+    uint64_t sequence = nextSequence++;
+    MarketDataSlot& slot = slots[(sequence - 1) & mask];
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(slot.body, reinterpret_cast<const char*>(&event) + sizeof(uint64_t), sizeof(slot.body));
+    slot.sequence.store(sequence, std::memory_order_release);
+    header->published.store(sequence, std::memory_order_release);
+}
+
+MarketDataReader::MarketDataReader(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDWR);
+    if (fd < 0) throw std::runtime_error("Failed to open market data feed: " + path);
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(MarketDataHeader)) {
+        ::close(fd);
+        throw std::runtime_error("Not a market data feed: " + path);
+    }
+    mappedSize = static_cast<std::size_t>(st.st_size);
+    // Read-write only so requestSnapshot() can bump the request counter.
+    void* mapping = mapShared(fd, mappedSize, PROT_READ | PROT_WRITE, path);
+    header = static_cast<MarketDataHeader*>(mapping);
+    if (std::memcmp(header->magic, kMarketDataMagic, sizeof(kMarketDataMagic)) != 0 ||
+        header->version != kMarketDataVersion || header->eventSize != sizeof(MarketDataEvent) ||
+        mappedSize < sizeof(MarketDataHeader) + header->capacity * sizeof(MarketDataSlot)) {
+        ::munmap(mapping, mappedSize);
+        header = nullptr;
+        throw std::runtime_error("Not a market data feed: " + path);
+    }
+    capacity = header->capacity;
+    slots = reinterpret_cast<const MarketDataSlot*>(static_cast<const char*>(mapping) + sizeof(MarketDataHeader));
+    expected = header->published.load(std::memory_order_acquire) + 1;
+}
+
+MarketDataReader::~MarketDataReader() {
+    if (header) ::munmap(header, mappedSize);
+}
+
+void MarketDataReader::rewind() {
+    uint64_t published = header->published.load(std::memory_order_acquire);
+    expected = published >= capacity ? published - capacity + 1 : 1;
+}
+
+void MarketDataReader::skipTo(uint64_t sequence) {
+    if (sequence > expected) lost += sequence - expected;
+    expected = sequence;
+}
+
+MarketDataReader::Result MarketDataReader::next(MarketDataEvent& event) {
+    uint64_t published = header->published.load(std::memory_order_acquire);
+    if (published < expected) return Result::EMPTY;
+    if (published - expected >= capacity) {
+        // The writer has lapped us; the oldest event still held is published - capacity + 1.
+        skipTo(published - capacity + 1);
+        return Result::GAP;
+    }
+
+    const MarketDataSlot& slot = slots[(expected - 1) & (capacity - 1)];
+    uint64_t before = slot.sequence.load(std::memory_order_acquire);
+    if (before != expected) {
+        // Being rewritten for a later lap, so this event is gone.
+        skipTo(header->published.load(std::memory_order_acquire) - capacity + 2);
+        return Result::GAP;
+    }
+    std::memcpy(reinterpret_cast<char*>(&event) + sizeof(uint64_t), slot.body, sizeof(slot.body));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) != before) {
+        skipTo(header->published.load(std::memory_order_acquire) - capacity + 2);
+        return Result::GAP;
+    }
+    event.sequence = before;
+    ++expected;
+    return Result::EVENT;
+}
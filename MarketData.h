@@ -0,0 +1,170 @@
+#ifndef MARKET_DATA_H
+#define MARKET_DATA_H
+
+#include "Order.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Incremental market data published by an OrderBook into a memory-mapped ring
+// that local processes read without involving the matching thread.
+//
+// L3 events follow individual resting orders (ADD, EXECUTE, CANCEL); L2 events
+// (LEVEL) give the change in total quantity and order count at one price. A
+// consumer rebuilds the book from a snapshot plus deltas: BOOK_RESET clears it,
+// the current book follows as ADD and LEVEL events from empty, and
+// SNAPSHOT_END marks the point from which live events apply. The engine
+// publishes a snapshot at start-up and whenever a reader asks for one.
+enum class MarketDataEventType : uint16_t {
+    BOOK_RESET = 1,
+    SNAPSHOT_END = 2,
+    ADD = 3,     // an order now rests: orderId, side, price, quantity (remaining)
+    EXECUTE = 4, // a resting order traded: orderId, side, price, quantity, otherId (aggressor), tradeId
+    CANCEL = 5,  // a resting order was cancelled: orderId, side, price, quantity (remaining)
+    LEVEL = 6,   // side, price, quantity (change in level total), otherId (change in order count)
+    // A resting order was amended: orderId, side, price, quantity (remaining, 0 if
+    // the new price traded it out). At the same price with less quantity it keeps
+    // its place in the queue; otherwise it has moved to the back of the level at price.
+    MODIFY = 7
+};
+
+// One event as handed to readers. Every command's events carry the same timestamp.
+struct MarketDataEvent {
+    uint64_t sequence;  // 1, 2, 3, ... with no gaps on the writer side
+    int64_t timestamp;  // nanoseconds since the epoch
+    uint16_t type;      // MarketDataEventType
+    uint16_t side;      // OrderType
+    int32_t price;
+    int64_t orderId;
+    int64_t otherId;
+    int64_t tradeId;
+    int32_t quantity;
+    int32_t reserved[3];
+};
+static_assert(sizeof(MarketDataEvent) == 64, "MarketDataEvent is part of the shared-memory layout");
+
+// Layout of the mapped file: this header, then `capacity` 64-byte slots.
+struct MarketDataHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t eventSize;
+    uint64_t capacity; // a power of two
+    char pad[40];
+    alignas(64) std::atomic<uint64_t> published;       // sequence of the last complete event
+    alignas(64) std::atomic<uint64_t> refreshRequests; // readers bump this to ask for a snapshot
+};
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "The feed needs lock-free 64-bit atomics");
+
+// A slot's sequence is zero while the writer fills it, then the event's
+// sequence. A reader that sees the sequence change under it knows the slot was
+// overwritten while it was copying.
+struct MarketDataSlot {
+    std::atomic<uint64_t> sequence;
+    unsigned char body[sizeof(MarketDataEvent) - sizeof(uint64_t)];
+};
+static_assert(sizeof(MarketDataSlot) == sizeof(MarketDataEvent), "Slots hold exactly one event");
+
+constexpr char kMarketDataMagic[8] = {'O', 'M', 'E', 'M', 'D', 'F', 'D', '1'};
+constexpr uint32_t kMarketDataVersion = 2;
+
+// The writer side, owned by the book's matching thread. It never waits for
+// readers: once the ring wraps, the oldest events are overwritten and readers
+// that had not got to them see a gap.
+class MarketDataFeed {
+public:
+    // Creates (or truncates) the feed file with room for `capacity` events,
+    // rounded up to a power of two. Throws std::runtime_error if it cannot.
+    MarketDataFeed(const std::string& path, std::size_t capacity);
+    ~MarketDataFeed();
+
+    MarketDataFeed(const MarketDataFeed&) = delete;
+    MarketDataFeed& operator=(const MarketDataFeed&) = delete;
+
+    // Timestamp given to the events published from now on.
+    void setTimestamp(int64_t nanos) { timestamp = nanos; }
+
+    void bookReset() { publish(MarketDataEventType::BOOK_RESET, OrderType::BUY, 0, 0, 0, 0, 0); }
+    void snapshotEnd() { publish(MarketDataEventType::SNAPSHOT_END, OrderType::BUY, 0, 0, 0, 0, 0); }
+    void add(const Order& order) {
+        publish(MarketDataEventType::ADD, order.type, order.price, order.id, order.remaining(), 0, 0);
+    }
+    void execute(OrderType restingSide, OrderId restingId, OrderId aggressorId, const Trade& trade) {
+        publish(MarketDataEventType::EXECUTE, restingSide, trade.price, restingId, trade.quantity, aggressorId,
+                trade.tradeId);
+    }
+    void cancel(const Order& order) {
+        publish(MarketDataEventType::CANCEL, order.type, order.price, order.id, order.remaining(), 0, 0);
+    }
+    void modify(const Order& order) {
+        publish(MarketDataEventType::MODIFY, order.type, order.price, order.id, order.remaining(), 0, 0);
+    }
+    void level(OrderType side, int price, int quantityChange, int orderCountChange) {
+        publish(MarketDataEventType::LEVEL, side, price, 0, quantityChange, orderCountChange, 0);
+    }
+
+    // Whether a reader has asked for a snapshot since the last call.
+    bool refreshRequested() {
+        uint64_t requests = header->refreshRequests.load(std::memory_order_relaxed);
+        if (requests == refreshesServed) return false;
+        refreshesServed = requests;
+        return true;
+    }
+
+    uint64_t sequence() const { return nextSequence - 1; }
+
+private:
+    void publish(MarketDataEventType type, OrderType side, int price, OrderId orderId, int quantity, int64_t otherId,
+                 int64_t tradeId);
+
+    std::string path;
+    std::size_t mappedSize = 0;
+    MarketDataHeader* header = nullptr;
+    MarketDataSlot* slots = nullptr;
+    uint64_t mask = 0;
+    uint64_t nextSequence = 1;
+    uint64_t refreshesServed = 0;
+    int64_t timestamp = 0;
+};
+
+// Follows a feed from another process (or thread).
+class MarketDataReader {
+public:
+    enum class Result { EVENT, EMPTY, GAP };
+
+    // Maps an existing feed file and starts after the last published event.
+    // Throws std::runtime_error if the file is missing or not a feed.
+    explicit MarketDataReader(const std::string& path);
+    ~MarketDataReader();
+
+    MarketDataReader(const MarketDataReader&) = delete;
+    MarketDataReader& operator=(const MarketDataReader&) = delete;
+
+    // Takes the next event. EMPTY means nothing new has been published yet.
+    // GAP means events were overwritten before they could be read: the reader
+    // skips ahead to the oldest event still in the ring and lostEvents() says
+    // how many were missed. Ask for a snapshot to resynchronise.
+    Result next(MarketDataEvent& event);
+
+    // Asks the engine to publish a fresh snapshot after its current command.
+    void requestSnapshot() { header->refreshRequests.fetch_add(1, std::memory_order_relaxed); }
+
+    // Moves to the oldest event still held in the ring.
+    void rewind();
+
+    uint64_t expectedSequence() const { return expected; }
+    uint64_t lostEvents() const { return lost; }
+
+private:
+    void skipTo(uint64_t sequence);
+
+    std::size_t mappedSize = 0;
+    MarketDataHeader* header = nullptr;
+    const MarketDataSlot* slots = nullptr;
+    uint64_t capacity = 0;
+    uint64_t expected = 1;
+    uint64_t lost = 0;
+};
+
+#endif // MARKET_DATA_H
@@ -2,24 +2,120 @@
 #define MATCHING_ENGINE_H
 
 #include "Order.h"
-#include <map>
-#include <queue>
-#include <vector>
+#include "BookSide.h"
+#include <algorithm> // For std::min
+#include <utility>
+
+// Compile-time description of the side an incoming order is on: the book it
+// matches against, whether its limit reaches a resting price, and which of
+// the two orders is the buyer. The matching core is instantiated once per
+// side, so neither loop carries a runtime side test.
+struct BuySide {
+    using OppositeBook = SellBook;
+
+    // A buy reaches any sell priced at or below its limit.
+    static bool crosses(int limit, int restingPrice) { return limit >= restingPrice; }
+
+    static Trade trade(int64_t id, const Order& buy, const Order& sell, int quantity, Timestamp timestamp) {
+        return {id, buy.id, sell.id, sell.price, quantity, timestamp};
+    }
+};
+
+struct SellSide {
+    using OppositeBook = BuyBook;
+
+    // A sell reaches any buy priced at or above its limit.
+    static bool crosses(int limit, int restingPrice) { return limit <= restingPrice; }
+
+    static Trade trade(int64_t id, const Order& sell, const Order& buy, int quantity, Timestamp timestamp) {
+        return {id, buy.id, sell.id, buy.price, quantity, timestamp};
+    }
+};
 
 // Contains the core logic for matching buy and sell orders.
 class MatchingEngine {
 public:
+    // Matches an incoming order on `Side` against the opposite book, best
+    // price first and in time priority within a price, handing each fill to
+    // `onTrade(const Trade&, Order& resting)` as soon as it happens, so callers
+    // can consume fills without an intermediate container. Every fill is stamped
+    // with `now`, the time of the command being matched.
+    // Both orders are already updated when the sink runs. A resting order that
+    // is completely filled has been unlinked from its level and is not touched
+    // again by the matcher, so the sink may release it.
+    template <typename Side, typename TradeSink>
+    void match(Order& incoming, typename Side::OppositeBook& book, int64_t& tradeId, Timestamp now,
+               TradeSink&& onTrade);
+
+    // Whether the opposite book holds enough quantity within the incoming
+    // order's limit to fill all of it. Sums the level totals from the best
+    // price outwards, so it costs one step per level, not per order, and
+    // leaves the book untouched. Used to reject fill-or-kill orders up front.
+    template <typename Side>
+    bool canFill(const Order& incoming, const typename Side::OppositeBook& book) const;
+
     // Matches a new buy order against the existing sell book.
-    std::vector<Trade> matchBuyOrder(Order& newBuyOrder, 
-                                     std::map<int, std::queue<Order>>& sellOrders,
-                                     int& tradeId);
+    template <typename TradeSink>
+    void matchBuyOrder(Order& newBuyOrder, SellBook& sellOrders, int64_t& tradeId, Timestamp now, TradeSink&& onTrade) {
+        match<BuySide>(newBuyOrder, sellOrders, tradeId, now, std::forward<TradeSink>(onTrade));
+    }
 
     // Matches a new sell order against the existing buy book.
-    std::vector<Trade> matchSellOrder(Order& newSellOrder, 
-                                      std::map<int, std::queue<Order>, std::greater<int>>& buyOrders,
-                                      int& tradeId);
+    template <typename TradeSink>
+    void matchSellOrder(Order& newSellOrder, BuyBook& buyOrders, int64_t& tradeId, Timestamp now, TradeSink&& onTrade) {
+        match<SellSide>(newSellOrder, buyOrders, tradeId, now, std::forward<TradeSink>(onTrade));
+    }
+
 private:
-    time_t getCurrentTimestamp() const;
+    // Market orders reach every resting price; limit orders only those they cross.
+    template <typename Side>
+    static bool reaches(const Order& incoming, int restingPrice) {
+        return incoming.kind == OrderKind::MARKET || Side::crosses(incoming.price, restingPrice);
+    }
 };
 
+template <typename Side>
+bool MatchingEngine::canFill(const Order& incoming, const typename Side::OppositeBook& book) const {
+    int64_t available = 0;
+    book.forEachLevel([&](int price, const PriceLevel& level) {
+        if (!reaches<Side>(incoming, price)) return false;
+        available += level.quantity;
+        return available < incoming.remaining();
+    });
+    return available >= incoming.remaining();
+}
+
+template <typename Side, typename TradeSink>
+void MatchingEngine::match(Order& incoming, typename Side::OppositeBook& book, int64_t& tradeId, Timestamp now,
+                           TradeSink&& onTrade) {
+    // Iterate through the opposite side from its best price towards its worst.
+    while (!book.empty() && !incoming.is_filled()) {
+        int price = book.bestPrice();
+        if (!reaches<Side>(incoming, price)) {
+            // The incoming limit does not reach the best resting price, no more matches possible.
+            break;
+        }
+
+        auto& q = book.bestLevel();
+        while (!q.empty() && !incoming.is_filled()) {
+            Order& resting = q.front();
+            int tradedQty = std::min(incoming.remaining(), resting.remaining());
+            const Trade trade = Side::trade(tradeId++, incoming, resting, tradedQty, now);
+
+            incoming.filled_quantity += tradedQty;
+            q.fill(resting, tradedQty);
+
+            if (resting.is_filled()) {
+                q.pop_front(); // The resting order is completely filled
+            }
+            onTrade(trade, resting);
+        }
+        
+        if (q.empty()) {
+            // Erase the price level if no more orders exist there.
+            book.eraseLevel(price);
+        }
+    }
+}
+
 #endif // MATCHING_ENGINE_H
@@ -0,0 +1,80 @@
+#ifndef MPSC_RING_H
+#define MPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Bounded multi-producer/single-consumer queue of fixed-size items. Any number
+// of threads may push concurrently; one thread pops. Producers claim a slot
+// with a single compare-and-swap on the head and publish it through the slot's
+// own sequence number, so no producer ever waits for another to finish copying.
+template <typename T>
+class MpscRing {
+public:
+    explicit MpscRing(std::size_t capacity) {
+        std::size_t size = 2;
+        while (size < capacity) size <<= 1;
+        slots.reset(new Slot[size]);
+        mask = size - 1;
+        for (std::size_t i = 0; i < size; ++i) slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    MpscRing(const MpscRing&) = delete;
+    MpscRing& operator=(const MpscRing&) = delete;
+
+    // Producer side, from any thread. Returns false if the ring is full.
+    bool tryPush(const T& item) {
+        std::size_t pos = head.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            slot = &slots[pos & mask];
+            std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            intptr_t lag = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (lag == 0) {
+                // The slot is free for this lap; claim it.
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (lag < 0) {
+                return false; // the consumer has not freed this slot yet
+            } else {
+                pos = head.load(std::memory_order_relaxed); // another producer took it
+            }
+        }
+        slot->item = item;
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Returns false if the next slot has not been published yet.
+    bool tryPop(T& item) {
+        Slot& slot = slots[tail & mask];
+        if (slot.sequence.load(std::memory_order_acquire) != tail + 1) return false;
+        item = slot.item;
+        slot.sequence.store(tail + mask + 1, std::memory_order_release);
+        ++tail;
+        return true;
+    }
+
+    // Consumer side. Pops up to max items into out and returns how many.
+    std::size_t popBatch(T* out, std::size_t max) {
+        std::size_t n = 0;
+        while (n < max && tryPop(out[n])) ++n;
+        return n;
+    }
+
+    std::size_t capacity() const { return mask + 1; }
+
+private:
+    struct Slot {
+        std::atomic<std::size_t> sequence{0};
+        T item;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    std::size_t mask = 0;
+    alignas(64) std::atomic<std::size_t> head{0}; // next slot a producer claims
+    alignas(64) std::size_t tail = 0;             // next slot the consumer reads
+};
+
+#endif // MPSC_RING_H
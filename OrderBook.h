@@ -4,45 +4,213 @@
 #include "Order.h"
 #include "Logger.h"
 #include "Persistence.h"
+#include "Journal.h"
+#include "Snapshot.h"
 #include "MatchingEngine.h"
+#include "BookSide.h"
+#include "OrderPool.h"
+#include "EngineStats.h"
+#include "MarketData.h"
+#include "DepthSnapshot.h"
+#include "EngineClock.h"
+#include "Recording.h"
 
-#include <map>
-#include <queue>
-#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Start-up options for an OrderBook.
+struct OrderBookConfig {
+    // Directory for this book's CSV books, trade log, journal and snapshot.
+    // Empty means the working directory.
+    std::string dataDir;
+
+    // Keep price levels in a tick-indexed ladder covering [ladderMinPrice, ladderMaxPrice]
+    // instead of std::map. Orders priced outside the band are rejected.
+    bool useLadder = false;
+    int ladderMinPrice = 1;
+    int ladderMaxPrice = 0;
+
+    // Orders and price levels are preallocated for this many live entries at
+    // start-up and recycled afterwards. The pools grow if they are exceeded.
+    std::size_t orderPoolCapacity = 1 << 16;
+    std::size_t levelPoolCapacity = 4096;
+
+    // When trades.csv batches are written and how durably.
+    TradeCommitPolicy tradeCommit;
+
+    // Take a snapshot (and restart the journal) every this many journal
+    // records. Zero means only at shutdown or on request.
+    std::size_t snapshotInterval = 0;
+
+    // Threads used to parse the CSV books on a first start without a journal.
+    unsigned importThreads = 1;
+
+    // Do not print each trade to stdout (trades are still logged and persisted).
+    bool quiet = false;
+
+    // Keep the journal, trade log, CSV books and snapshots. When false the book
+    // lives in memory only: it starts empty and nothing is written to disk.
+    bool persist = true;
+
+    // Publish incremental L2/L3 market data into this memory-mapped ring (see
+    // MarketData.h). A relative path is inside dataDir. Empty disables the feed.
+    std::string marketDataFile;
+    std::size_t marketDataCapacity = 1 << 16; // events held before the oldest are overwritten
+
+    // Keep the best bid and offer and the top levels of each side in this
+    // shared file, updated after every command (see DepthSnapshot.h). A
+    // relative path is inside dataDir. Empty disables it.
+    std::string depthFile;
+
+    // Record every inbound command to this file, with the book it starts from
+    // beside it, for the replay tool (see Recording.h). A relative path is
+    // inside dataDir. Empty disables it.
+    std::string recordFile;
+
+    // Where command timestamps come from. Empty gives the book a CalibratedClock
+    // of its own; replays and tests pass a FakeClock. Only this book may read it.
+    std::shared_ptr<EngineClock> clock;
+};
+
+// Occupancy of the order book's preallocated pools, for sizing them in production.
+struct PoolStats {
+    std::size_t orderCapacity;
+    std::size_t ordersInUse;
+    std::size_t orderHighWater;
+    std::size_t orderSlabGrowths;
+    std::size_t indexCapacity;
+    std::size_t indexGrowths;
+    std::size_t buyLevels;
+    std::size_t sellLevels;
+    std::size_t spareLevels;
+    std::size_t levelAllocations; // map nodes allocated because no spare was left
+};
 
 // The central class that orchestrates the entire process.
 class OrderBook {
 public:
-    OrderBook(std::shared_ptr<Logger> logger);
+    OrderBook(std::shared_ptr<Logger> logger, const OrderBookConfig& config = OrderBookConfig());
     ~OrderBook();
 
-    // Places a new order and attempts to match it.
-    void placeOrder(OrderType type, int price, int quantity);
+    // Places a new limit order and attempts to match it. Returns the new order's id.
+    // With IOC the unfilled remainder is dropped instead of resting. With FOK the
+    // order is rejected (std::runtime_error) without touching the book unless it
+    // can fill in full. A non-zero owner tags the order with the session that
+    // placed it, for massCancel.
+    OrderId placeOrder(OrderType type, int price, int quantity, TimeInForce timeInForce = TimeInForce::GTC,
+                       uint16_t owner = 0);
+
+    // Places a market order, which trades at any price and never rests. It must
+    // be IOC or FOK; otherwise as placeOrder.
+    OrderId placeMarketOrder(OrderType type, int quantity, TimeInForce timeInForce = TimeInForce::IOC,
+                             uint16_t owner = 0);
 
     // Cancels an existing order.
-    void cancelOrder(int id);
+    void cancelOrder(OrderId id);
+
+    // Changes a resting order's price and total quantity (including what has
+    // already filled), keeping its id. Lowering the quantity at the same price
+    // keeps its place in the queue; any other change moves it to the back of
+    // the level at the new price, matching first if that price crosses.
+    void modifyOrder(OrderId id, int newPrice, int newQuantity);
+
+    // Cancels every resting order the filter selects and returns how many there
+    // were. Without an owner only the price levels inside the band are visited,
+    // and each is dropped whole; with one, only that owner's orders are. The
+    // whole cancel is journaled as one record.
+    std::size_t massCancel(const MassCancelFilter& filter);
     
-    // Displays the top of the buy and sell books.
+    // Displays the total quantity and order count at the best price of each side.
     void showBook() const;
 
+    // Copies up to maxLevels of the best price levels of one side into out,
+    // best first, and returns how many there were. O(maxLevels): every level
+    // keeps its total remaining quantity and order count up to date.
+    std::size_t depth(OrderType side, DepthLevel* out, std::size_t maxLevels) const;
+
+    // Writes the resting orders to the CSV books. Recovery uses the journal,
+    // so this only runs on request and at shutdown.
+    void exportBook();
+
+    // Writes a binary snapshot of the whole book and restarts the journal
+    // after it, so the next restart only replays what happens from here on.
+    void takeSnapshot();
+
+    // Reports how full the order and price level pools are.
+    PoolStats poolStats() const;
+
+    // Trades matched since the book was opened.
+    uint64_t tradeCount() const { return tradesMatched; }
+
+    // Reports batch sizes and latency of trade log commits.
+    const TradeCommitStats& tradeCommitStats() const;
+
+    // Prints order/trade/cancel counts and the latency percentiles of each stage
+    // of placeOrder and cancelOrder. The same report goes to stats.txt at shutdown.
+    void printStats(std::ostream& out) const;
+
 private:
-    int nextOrderId = 1;
-    int nextTradeId = 1;
+    OrderId nextOrderId = 1;
+    int64_t nextTradeId = 1;
 
-    std::map<int, std::queue<Order>, std::greater<int>> buyOrders; // Buys, sorted high to low
-    std::map<int, std::queue<Order>> sellOrders;                   // Sells, sorted low to high
+    BuyBook buyOrders;   // Buys, sorted high to low
+    SellBook sellOrders; // Sells, sorted low to high
 
-    // For fast lookups and status tracking
-    std::unordered_map<int, Order> allOrders;
+    // Every live order is a node from orderPool; allOrders finds it by id.
+    OrderPool orderPool;
+    OrderIndex allOrders;
+    OwnerIndex owners;
 
     std::shared_ptr<Logger> logger;
     std::unique_ptr<PersistenceManager> persistence;
+    std::unique_ptr<Journal> journal;
+    std::string snapshotFile;
+    std::size_t snapshotInterval;
+    unsigned importThreads;
+    bool quiet;
+    uint64_t tradesMatched = 0;
+
+    std::unique_ptr<MarketDataFeed> marketData;
+    std::unique_ptr<DepthPublisher> depthPublisher;
+    std::unique_ptr<CommandRecorder> recorder;
+    EngineStats stats;
+    std::string statsFile; // where the stats are written at shutdown; empty without persistence
     std::unique_ptr<MatchingEngine> matchingEngine;
 
-    void processTrades(const std::vector<Trade>& trades);
-    time_t getCurrentTimestamp() const;
-    void updateOrderStatus(int orderId);
+    std::shared_ptr<EngineClock> clock;
+    Timestamp commandTime = 0; // when the command being applied arrived
+
+    // Fills of the current order at one price not yet published as a market data level change.
+    struct LevelChange {
+        int price = 0;
+        int quantity = 0;
+        int orders = 0;
+    };
+    LevelChange pendingLevel;
+
+    OrderId submitOrder(const Order& incoming, uint16_t owner);
+    void matchAndRest(Order& order);
+    void publishPendingLevel(OrderType incomingSide);
+    void reportTrade(const Order& incoming, const Trade& trade, Order& resting);
+    bool canRestore(const Order& order);
+    Order* addRestingOrder(const Order& order, Timestamp timestamp, uint16_t owner);
+    template <typename Record>
+    void addRestingOrders(const Record* orders, std::size_t count, bool journalNew);
+    bool unlinkOrder(Order* order);
+    std::size_t cancelMatching(const MassCancelFilter& filter);
+    void releaseOrder(Order* order);
+    void applyJournalRecord(const JournalRecord& record);
+    void recover();
+    void maybeSnapshot();
+    void publishMarketDataSnapshot();
+    void publishDepth();
+    void stampCommand();
+    void startRecording(const OrderBookConfig& config);
+    void updateOrderStatus(OrderId orderId);
 };
 
 #endif // ORDER_BOOK_H
@@ -0,0 +1,226 @@
+#ifndef ORDER_POOL_H
+#define ORDER_POOL_H
+
+#include "Order.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <vector>
+
+// Slab allocator for Order nodes. Each slab is one kSlabBytes block aligned to
+// its own size: the hot Order records fill the front of it and their OrderInfo
+// records follow in a parallel array, so the matching loop walks densely packed
+// 32-byte orders and an order's cold half is found from its address alone.
+//
+// The slabs needed for the configured capacity are allocated up front;
+// released orders go onto a free list (threaded through Order::next) and are
+// handed out again before any new memory is requested. If the pool runs dry it
+// allocates another slab and counts it. Only pooled orders may be linked into
+// a price level, since the level keeps its back links in OrderInfo.
+class OrderPool {
+public:
+    static constexpr std::size_t kSlabBytes = std::size_t(1) << 21;
+    static constexpr std::size_t kOrdersPerSlab = kSlabBytes / (sizeof(Order) + sizeof(OrderInfo));
+
+    explicit OrderPool(std::size_t capacity) {
+        do {
+            addSlab();
+        } while (slabs.size() * kOrdersPerSlab < capacity);
+        slabGrowths = 0; // The initial slabs are not growth.
+    }
+
+    OrderPool(const OrderPool&) = delete;
+    OrderPool& operator=(const OrderPool&) = delete;
+
+    // The cold half of a pooled order.
+    static OrderInfo& info(Order* order) {
+        auto address = reinterpret_cast<uintptr_t>(order);
+        uintptr_t slab = address & ~static_cast<uintptr_t>(kSlabBytes - 1);
+        std::size_t index = (address - slab) / sizeof(Order);
+        return reinterpret_cast<OrderInfo*>(slab + kOrdersPerSlab * sizeof(Order))[index];
+    }
+    static const OrderInfo& info(const Order* order) { return info(const_cast<Order*>(order)); }
+
+    // Takes a node from the pool and initialises it with a copy of the given
+    // order and the cold fields it does not carry.
+    Order* acquire(const Order& init, Timestamp timestamp, uint16_t owner = 0) {
+        if (!freeList) addSlab();
+        Order* node = freeList;
+        freeList = node->next;
+        *node = init;
+        node->next = nullptr;
+        OrderInfo& cold = info(node);
+        cold = OrderInfo{};
+        cold.timestamp = timestamp;
+        cold.owner = owner;
+        if (++used > peak) peak = used;
+        return node;
+    }
+
+    // Returns a node to the pool. The order must no longer be linked into a level.
+    void release(Order* node) {
+        node->next = freeList;
+        freeList = node;
+        --used;
+    }
+
+    std::size_t capacity() const { return slabs.size() * kOrdersPerSlab; }
+    std::size_t inUse() const { return used; }
+    std::size_t highWater() const { return peak; }
+    std::size_t growths() const { return slabGrowths; }
+
+private:
+    struct FreeSlab {
+        void operator()(void* slab) const { std::free(slab); }
+    };
+
+    void addSlab() {
+        void* block = std::aligned_alloc(kSlabBytes, kSlabBytes);
+        if (!block) throw std::bad_alloc();
+        slabs.emplace_back(block);
+        Order* orders = static_cast<Order*>(block);
+        std::uninitialized_default_construct_n(orders, kOrdersPerSlab);
+        std::uninitialized_default_construct_n(&info(orders), kOrdersPerSlab);
+        // Hand out the slab from its start so consecutive orders share cache lines.
+        for (std::size_t i = kOrdersPerSlab; i-- > 0;) {
+            orders[i].next = freeList;
+            freeList = &orders[i];
+        }
+        ++slabGrowths;
+    }
+
+    std::vector<std::unique_ptr<void, FreeSlab>> slabs;
+    Order* freeList = nullptr;
+    std::size_t used = 0;
+    std::size_t peak = 0;
+    std::size_t slabGrowths = 0;
+};
+
+// Maps order ids to their pooled nodes. Open addressing with linear probing in a
+// table sized from the expected number of live orders, so inserts and erases do
+// not allocate. The table doubles (and counts it) if it gets more than half full.
+class OrderIndex {
+public:
+    explicit OrderIndex(std::size_t expected) {
+        std::size_t size = 16;
+        while (size < expected * 2) size <<= 1;
+        slots.assign(size, Slot{});
+        mask = size - 1;
+    }
+
+    Order* find(OrderId id) const {
+        for (std::size_t i = home(id);; i = (i + 1) & mask) {
+            const Slot& slot = slots[i];
+            if (!slot.order) return nullptr;
+            if (slot.id == id) return slot.order;
+        }
+    }
+
+    // Returns false (and leaves the index unchanged) if the id is already present.
+    bool insert(OrderId id, Order* order) {
+        if ((count + 1) * 2 > slots.size()) grow();
+        for (std::size_t i = home(id);; i = (i + 1) & mask) {
+            Slot& slot = slots[i];
+            if (!slot.order) {
+                slot = Slot{id, order};
+                ++count;
+                return true;
+            }
+            if (slot.id == id) return false;
+        }
+    }
+
+    bool erase(OrderId id) {
+        std::size_t i = home(id);
+        for (;; i = (i + 1) & mask) {
+            if (!slots[i].order) return false;
+            if (slots[i].id == id) break;
+        }
+        // Backward-shift deletion: pull later entries of the probe run into the
+        // hole so lookups never need tombstones.
+        std::size_t hole = i;
+        for (std::size_t j = (hole + 1) & mask; slots[j].order; j = (j + 1) & mask) {
+            std::size_t want = home(slots[j].id);
+            if (((j - want) & mask) >= ((j - hole) & mask)) {
+                slots[hole] = slots[j];
+                hole = j;
+            }
+        }
+        slots[hole] = Slot{};
+        --count;
+        return true;
+    }
+
+    std::size_t size() const { return count; }
+    std::size_t capacity() const { return slots.size() / 2; }
+    std::size_t growths() const { return tableGrowths; }
+
+private:
+    struct Slot {
+        OrderId id = 0;
+        Order* order = nullptr; // nullptr marks an empty slot
+    };
+
+    std::size_t home(OrderId id) const {
+        // Fibonacci hashing spreads sequential ids across the table.
+        return static_cast<std::size_t>((static_cast<uint64_t>(id) * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+    }
+
+    void grow() {
+        std::vector<Slot> old;
+        old.swap(slots);
+        slots.assign(old.size() * 2, Slot{});
+        mask = slots.size() - 1;
+        count = 0;
+        for (const Slot& slot : old) {
+            if (slot.order) insert(slot.id, slot.order);
+        }
+        ++tableGrowths;
+    }
+
+    std::vector<Slot> slots;
+    std::size_t mask = 0;
+    std::size_t count = 0;
+    std::size_t tableGrowths = 0;
+};
+
+// Threads every live order that has an owner onto its owner's list, through
+// OrderInfo::ownerPrev/ownerNext, so all of one owner's orders can be visited
+// without scanning the book. Orders without an owner are not tracked.
+class OwnerIndex {
+public:
+    void link(Order* order) {
+        OrderInfo& cold = OrderPool::info(order);
+        if (cold.owner == 0) return;
+        if (heads.size() <= cold.owner) heads.resize(cold.owner + 1u, nullptr);
+        Order*& head = heads[cold.owner];
+        cold.ownerPrev = nullptr;
+        cold.ownerNext = head;
+        if (head) OrderPool::info(head).ownerPrev = order;
+        head = order;
+    }
+
+    void unlink(Order* order) {
+        OrderInfo& cold = OrderPool::info(order);
+        if (cold.owner == 0) return;
+        if (cold.ownerPrev) {
+            OrderPool::info(cold.ownerPrev).ownerNext = cold.ownerNext;
+        } else {
+            heads[cold.owner] = cold.ownerNext;
+        }
+        if (cold.ownerNext) OrderPool::info(cold.ownerNext).ownerPrev = cold.ownerPrev;
+        cold.ownerPrev = nullptr;
+        cold.ownerNext = nullptr;
+    }
+
+    // Most recently linked order of this owner; follow OrderInfo::ownerNext for the rest.
+    Order* first(uint16_t owner) const { return owner < heads.size() ? heads[owner] : nullptr; }
+
+private:
+    std::vector<Order*> heads; // indexed by owner
+};
+
+#endif // ORDER_POOL_H
@@ -1,95 +1,168 @@
 #include "Persistence.h"
+#include "CsvImport.h"
+#include "OrderPool.h"
 #include <fstream>
-#include <sstream>
 #include <iostream>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
-PersistenceManager::PersistenceManager(const std::string& buy_file, const std::string& sell_file, const std::string& trades_file)
-    : buy_orders_file(buy_file), sell_orders_file(sell_file), trades_file(trades_file) {
+namespace {
+
+// A trades.csv line: six integer fields, each at most 20 characters (a sign and
+// 19 digits), separated by commas and ended by a newline.
+constexpr std::size_t kTradeFields = 6;
+constexpr std::size_t kMaxTradeLine = kTradeFields * 20 + kTradeFields;
+static_assert(std::numeric_limits<long long>::digits10 + 2 <= 20, "a trade field can exceed 20 characters");
+
+} // namespace
+
+PersistenceManager::PersistenceManager(const std::string& buy_file, const std::string& sell_file, const std::string& trades_file,
+                                       const TradeCommitPolicy& commitPolicy)
+    : buy_orders_file(buy_file), sell_orders_file(sell_file), trades_file(trades_file), commitPolicy(commitPolicy) {
     
-    trades_log_stream.open(trades_file, std::ios::app);
-    if (trades_log_stream.tellp() == 0) {
-        trades_log_stream << "TradeID,BuyOrderID,SellOrderID,Price,Quantity,Timestamp\n";
+    // A raw descriptor so that each batch is exactly one write() and can be fdatasync'd.
+    trades_fd = ::open(trades_file.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+    if (trades_fd < 0) {
+        throw std::runtime_error("Failed to open trades file: " + trades_file);
+    }
+    pendingTrades.reserve(commitPolicy.maxBatchBytes + kMaxTradeLine);
+
+    struct stat st;
+    if (::fstat(trades_fd, &st) == 0 && st.st_size == 0) {
+        static const char header[] = "TradeID,BuyOrderID,SellOrderID,Price,Quantity,Timestamp\n";
+        pendingTrades.insert(pendingTrades.end(), header, header + sizeof(header) - 1);
+        flushTrades();
     }
 }
 
-void PersistenceManager::loadOrders(std::map<int, std::queue<Order>, std::greater<int>>& buyOrders, std::map<int, std::queue<Order>>& sellOrders) {
-    loadOrderType(buy_orders_file, OrderType::BUY, buyOrders);
-    loadOrderType(sell_orders_file, OrderType::SELL, sellOrders);
+PersistenceManager::~PersistenceManager() {
+    if (!pendingTrades.empty()) flushTrades();
+    if (trades_fd >= 0) ::close(trades_fd);
+}
+
+void PersistenceManager::loadOrders(std::vector<SavedOrder>& buyOrders, std::vector<SavedOrder>& sellOrders, unsigned threads) {
+    CsvImporter importer(threads);
+    if (!importer.importOrders(buy_orders_file, OrderType::BUY, buyOrders)) {
+        // It's okay if files don't exist on first run.
+        std::cerr << "Warning: Could not open " << buy_orders_file << " for loading. Starting fresh." << std::endl;
+    }
+    if (!importer.importOrders(sell_orders_file, OrderType::SELL, sellOrders)) {
+        std::cerr << "Warning: Could not open " << sell_orders_file << " for loading. Starting fresh." << std::endl;
+    }
+}
+
+void PersistenceManager::loadTrades(std::vector<Trade>& trades, unsigned threads) {
+    CsvImporter importer(threads);
+    importer.importTrades(trades_file, trades);
 }
 
 
 void PersistenceManager::logTrade(const Trade& trade) {
-    if (trades_log_stream.is_open()) {
-        trades_log_stream << trade.tradeId << ","
-                          << trade.buyOrderId << ","
-                          << trade.sellOrderId << ","
-                          << trade.price << ","
-                          << trade.quantity << ","
-                          << trade.timestamp << "\n";
-        trades_log_stream.flush();
+    if (pendingCount == 0) pendingSince = std::chrono::steady_clock::now();
+
+    // Encode straight into the batch buffer: grow it by the longest possible
+    // line, write the fields in place, then give back what was not used.
+    std::size_t start = pendingTrades.size();
+    pendingTrades.resize(start + kMaxTradeLine);
+    char* p = pendingTrades.data() + start;
+    char* end = p + kMaxTradeLine;
+    const long long fields[kTradeFields] = {
+        static_cast<long long>(trade.tradeId),  static_cast<long long>(trade.buyOrderId),
+        static_cast<long long>(trade.sellOrderId), static_cast<long long>(trade.price),
+        static_cast<long long>(trade.quantity), static_cast<long long>(trade.timestamp)};
+    for (std::size_t i = 0; i < kTradeFields; ++i) {
+        std::to_chars_result result = std::to_chars(p, end, fields[i]);
+        if (result.ec != std::errc()) {
+            pendingTrades.resize(start);
+            throw std::runtime_error("Trade " + std::to_string(trade.tradeId) + " does not fit a trade log line");
+        }
+        p = result.ptr;
+        *p++ = i + 1 < kTradeFields ? ',' : '\n';
     }
+    pendingTrades.resize(static_cast<std::size_t>(p - pendingTrades.data()));
+    ++pendingCount;
 }
 
 
-template<typename TMap>
-void PersistenceManager::loadOrderType(const std::string& filename, OrderType type, TMap& orders) {
-    std::ifstream in(filename);
-    if (!in.is_open()) {
-        // It's okay if files don't exist on first run.
-        std::cerr << "Warning: Could not open " << filename << " for loading. Starting fresh." << std::endl;
-        return;
-    }
+void PersistenceManager::commitTrades() {
+    if (pendingTrades.empty()) return;
 
-    std::string line;
-    getline(in, line); // skip header
-
-    while (getline(in, line)) {
-        if (line.empty()) continue;
-        std::stringstream ss(line);
-        std::string token;
-        Order o;
-        try {
-            getline(ss, token, ','); o.id = stoi(token);
-            getline(ss, token, ','); o.price = stoi(token);
-            getline(ss, token, ','); o.quantity = stoi(token);
-            getline(ss, token, ','); o.filled_quantity = stoi(token);
-            getline(ss, token, ','); o.timestamp = stol(token);
-            o.type = type;
-
-            orders[o.price].push(o);
-        } catch (const std::exception& e) {
-            std::cerr << "Error parsing line in " << filename << ": " << line << " - " << e.what() << std::endl;
-        }
+    bool batchComplete;
+    if (pendingTrades.size() >= commitPolicy.maxBatchBytes) {
+        batchComplete = true;
+    } else if (commitPolicy.window.count() > 0) {
+        batchComplete = std::chrono::steady_clock::now() - pendingSince >= commitPolicy.window;
+    } else {
+        batchComplete = commitPolicy.durability != TradeDurability::NONE;
     }
+    if (batchComplete) flushTrades();
 }
 
-// Explicit instantiations for the map types we use
-template void PersistenceManager::loadOrderType<std::map<int, std::queue<Order>, std::greater<int>>>(const std::string&, OrderType, std::map<int, std::queue<Order>, std::greater<int>>&);
-template void PersistenceManager::loadOrderType<std::map<int, std::queue<Order>>>(const std::string&, OrderType, std::map<int, std::queue<Order>>&);
-
-
-void PersistenceManager::exportActiveOrders(const std::map<int, std::queue<Order>, std::greater<int>>& buyOrders, const std::map<int, std::queue<Order>>& sellOrders) {
-    std::ofstream buyOut(buy_orders_file);
-    buyOut << "OrderID,Price,Quantity,FilledQuantity,Timestamp\n";
-    for (const auto& pair : buyOrders) {
-        auto q = pair.second; // Make a copy to iterate
-        while (!q.empty()) {
-            const auto& o = q.front();
-            buyOut << o.id << "," << o.price << "," << o.quantity << ","
-                   << o.filled_quantity << "," << o.timestamp << "\n";
-            q.pop();
+
+bool PersistenceManager::flushTrades() {
+    auto start = std::chrono::steady_clock::now();
+
+    const char* data = pendingTrades.data();
+    std::size_t left = pendingTrades.size();
+    while (left > 0) {
+        ssize_t written = ::write(trades_fd, data, left);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            // Keep what did not make it, starting mid-line if need be, so the
+            // next commit carries on from exactly where this write stopped.
+            std::cerr << "Error writing " << trades_file << ": " << std::strerror(errno) << std::endl;
+            ++commitStats.writeFailures;
+            pendingTrades.erase(pendingTrades.begin(), pendingTrades.begin() + (data - pendingTrades.data()));
+            return false;
         }
+        data += written;
+        left -= static_cast<std::size_t>(written);
+    }
+    bool synced = true;
+    if (commitPolicy.durability == TradeDurability::FDATASYNC && ::fdatasync(trades_fd) != 0) {
+        std::cerr << "Error syncing " << trades_file << ": " << std::strerror(errno) << std::endl;
+        ++commitStats.syncFailures;
+        synced = false;
     }
 
-    std::ofstream sellOut(sell_orders_file);
-    sellOut << "OrderID,Price,Quantity,FilledQuantity,Timestamp\n";
-    for (const auto& pair : sellOrders) {
-        auto q = pair.second; // Make a copy to iterate
-        while (!q.empty()) {
-            const auto& o = q.front();
-            sellOut << o.id << "," << o.price << "," << o.quantity << ","
-                    << o.filled_quantity << "," << o.timestamp << "\n";
-            q.pop();
-        }
+    uint64_t nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    if (pendingCount > 0) {
+        ++commitStats.batches;
+        commitStats.trades += pendingCount;
+        commitStats.bytes += pendingTrades.size();
+        if (pendingCount > commitStats.maxBatchTrades) commitStats.maxBatchTrades = pendingCount;
+        commitStats.totalCommitNanos += nanos;
+        if (nanos > commitStats.maxCommitNanos) commitStats.maxCommitNanos = nanos;
     }
+
+    pendingTrades.clear();
+    pendingCount = 0;
+    return synced;
+}
+
+
+void PersistenceManager::exportActiveOrders(const BuyBook& buyOrders, const SellBook& sellOrders) {
+    exportOrderType(buy_orders_file, buyOrders);
+    exportOrderType(sell_orders_file, sellOrders);
+}
+
+
+template<typename TBook>
+void PersistenceManager::exportOrderType(const std::string& filename, const TBook& orders) {
+    std::ofstream out(filename);
+    out << "OrderID,Price,Quantity,FilledQuantity,Timestamp\n";
+    orders.forEachLevel([&](int, const PriceLevel& level) {
+        // Walk the level's links directly; no copy of the queue is needed.
+        for (const Order* o = level.head; o; o = o->next) {
+            out << o->id << "," << o->price << "," << o->quantity << ","
+                << o->filled_quantity << "," << OrderPool::info(o).timestamp << "\n";
+        }
+        return true;
+    });
 }
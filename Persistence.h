@@ -2,37 +2,91 @@
 #define PERSISTENCE_H
 
 #include "Order.h"
-#include <map>
-#include <queue>
+#include "BookSide.h"
 #include <vector>
 #include <string>
 #include<fstream>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// How hard commitTrades() pushes a batch of trades towards the disk.
+enum class TradeDurability {
+    NONE,      // buffer in memory; write only when the batch limit or window is reached
+    FLUSH,     // write() every batch to the OS
+    FDATASYNC  // write() and fdatasync() every batch
+};
+
+struct TradeCommitPolicy {
+    TradeDurability durability = TradeDurability::FLUSH;
+    // A pending batch is written at the end of the matching pass in which it
+    // grows past this many bytes...
+    std::size_t maxBatchBytes = 64 * 1024;
+    // ...or, if non-zero, once its oldest trade has waited this long. With a
+    // window of zero every commitTrades() call ends the batch.
+    std::chrono::microseconds window{0};
+};
+
+// Counters for sizing the trade commit policy.
+struct TradeCommitStats {
+    uint64_t batches = 0;
+    uint64_t trades = 0;
+    uint64_t bytes = 0;
+    uint64_t maxBatchTrades = 0;
+    uint64_t totalCommitNanos = 0; // time spent in write() and fdatasync()
+    uint64_t maxCommitNanos = 0;
+    uint64_t writeFailures = 0; // write() errors; the unwritten bytes are retried by the next commit
+    uint64_t syncFailures = 0;  // fdatasync() errors; those batches may not be on disk
+};
 
 // Manages loading and saving data to/from CSV files.
 class PersistenceManager {
 public:
-    PersistenceManager(const std::string& buy_file, const std::string& sell_file, const std::string& trades_file);
+    PersistenceManager(const std::string& buy_file, const std::string& sell_file, const std::string& trades_file,
+                       const TradeCommitPolicy& commitPolicy = TradeCommitPolicy());
+    // Commits any trades still pending.
+    ~PersistenceManager();
 
-    // Loads orders from a file into a map data structure.
-    void loadOrders(std::map<int, std::queue<Order>, std::greater<int>>& buyOrders,
-                    std::map<int, std::queue<Order>>& sellOrders);
+    // Loads the saved orders of each side, in the order they were queued,
+    // parsing each file with up to `threads` threads.
+    void loadOrders(std::vector<SavedOrder>& buyOrders, std::vector<SavedOrder>& sellOrders, unsigned threads = 1);
+
+    // Loads the trades already in the trades log.
+    void loadTrades(std::vector<Trade>& trades, unsigned threads = 1);
 
     // Exports the current state of active orders to their respective files.
-    void exportActiveOrders(const std::map<int, std::queue<Order>, std::greater<int>>& buyOrders,
-                            const std::map<int, std::queue<Order>>& sellOrders);
+    void exportActiveOrders(const BuyBook& buyOrders, const SellBook& sellOrders);
     
-    // Appends a completed trade to the trades log file.
+    // Adds a completed trade to the pending batch for the trades log file. Nothing
+    // is written before commitTrades(), so the book can journal the trades first.
     void logTrade(const Trade& trade);
 
+    // Ends a matching pass: writes the pending trades with a single write()
+    // if the commit policy says the batch is complete.
+    void commitTrades();
+
+    // Writes the pending trades now, whatever the commit policy. Returns false
+    // if they did not all reach the disk as the policy asks: on a write error
+    // the unwritten bytes stay pending and are retried by the next commit.
+    bool flushTrades();
+
+    const TradeCommitStats& tradeCommitStats() const { return commitStats; }
+
 private:
     std::string buy_orders_file;
     std::string sell_orders_file;
     std::string trades_file;
-    std::ofstream trades_log_stream;
+    int trades_fd = -1;
+
+    TradeCommitPolicy commitPolicy;
+    TradeCommitStats commitStats;
+    std::vector<char> pendingTrades; // CSV lines not yet written
+    std::size_t pendingCount = 0;
+    std::chrono::steady_clock::time_point pendingSince;
 
-    // Helper to load orders of a specific type
-    template<typename TMap>
-       void loadOrderType(const std::string& filename, OrderType type, TMap& orders);
+    // Helper to write every order resting in a book, level by level
+    template<typename TBook>
+    void exportOrderType(const std::string& filename, const TBook& orders);
 };
 
 #endif // PERSISTENCE_H
@@ -0,0 +1,102 @@
+#ifndef PRICE_LEVEL_H
+#define PRICE_LEVEL_H
+
+#include "Order.h"
+#include "OrderPool.h"
+
+#include <cstdint>
+
+// A FIFO of resting orders at one price, linked through the orders' own
+// next pointers and the prev pointers in their OrderInfo. The level never owns
+// the orders, it only links them, so any order can be unlinked in constant time
+// given a pointer to it. The head's prev is left stale rather than cleared, so
+// taking the front order touches nothing but its own hot half.
+//
+// The level also keeps the total remaining quantity and number of its orders
+// up to date, so depth queries never walk the queue. Fills against a linked
+// order must go through fill() for the total to stay right.
+struct PriceLevel {
+    Order* head = nullptr;
+    Order* tail = nullptr;
+    int64_t quantity = 0; // sum of remaining() over the queue
+    uint32_t count = 0;   // orders in the queue
+
+    bool empty() const { return head == nullptr; }
+
+    Order& front() { return *head; }
+    const Order& front() const { return *head; }
+
+    // Appends an order at the back of the queue (lowest time priority).
+    void push_back(Order* order) {
+        OrderPool::info(order).prev = tail;
+        order->next = nullptr;
+        if (tail) {
+            tail->next = order;
+        } else {
+            head = order;
+        }
+        tail = order;
+        quantity += order->remaining();
+        ++count;
+    }
+
+    // Appends an already linked run of orders (first..last through next and
+    // OrderInfo::prev) at the back of the queue, keeping their order.
+    void splice_back(Order* first, Order* last) {
+        OrderPool::info(first).prev = tail;
+        last->next = nullptr;
+        if (tail) {
+            tail->next = first;
+        } else {
+            head = first;
+        }
+        tail = last;
+        for (Order* order = first; order; order = order->next) {
+            quantity += order->remaining();
+            ++count;
+        }
+    }
+
+    // Records a fill against an order linked into this level.
+    void fill(Order& order, int filled) {
+        order.filled_quantity += filled;
+        quantity -= filled;
+    }
+
+    // Changes the total quantity of an order linked into this level in place,
+    // leaving its place in the queue alone.
+    void resize(Order& order, int newQuantity) {
+        quantity += newQuantity - order.quantity;
+        order.quantity = newQuantity;
+    }
+
+    // Removes the order at the front of the queue.
+    void pop_front() {
+        Order* order = head;
+        quantity -= order->remaining();
+        --count;
+        head = order->next;
+        if (!head) tail = nullptr;
+        order->next = nullptr;
+    }
+
+    // Unlinks an order from anywhere in the queue, keeping the others in order.
+    void erase(Order* order) {
+        if (order == head) {
+            pop_front();
+            return;
+        }
+        quantity -= order->remaining();
+        --count;
+        Order* prev = OrderPool::info(order).prev;
+        prev->next = order->next;
+        if (order->next) {
+            OrderPool::info(order->next).prev = prev;
+        } else {
+            tail = prev;
+        }
+        order->next = nullptr;
+    }
+};
+
+#endif // PRICE_LEVEL_H
@@ -0,0 +1,114 @@
+#include "Recording.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+constexpr char kMagic[8] = {'O', 'M', 'E', 'R', 'E', 'C', 'D', '1'};
+constexpr uint32_t kVersion = 1;
+
+struct RecordingHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags; // kLadderFlag
+    uint64_t tradesOffset;
+    int32_t ladderMinPrice;
+    int32_t ladderMaxPrice;
+};
+static_assert(sizeof(RecordingHeader) == 32, "RecordingHeader is part of the on-disk format");
+
+constexpr uint32_t kLadderFlag = 1;
+
+} // namespace
+
+CommandRecorder::CommandRecorder(const std::string& path, const RecordingInfo& info) {
+    out.open(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        throw std::runtime_error("Failed to open command recording: " + path);
+    }
+    RecordingHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.flags = info.useLadder ? kLadderFlag : 0;
+    header.tradesOffset = info.tradesOffset;
+    header.ladderMinPrice = info.ladderMinPrice;
+    header.ladderMaxPrice = info.ladderMaxPrice;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.flush();
+}
+
+void CommandRecorder::recordPlace(const Order& order, uint16_t owner, Timestamp timestamp) {
+    RecordedCommand command{};
+    command.type = static_cast<uint16_t>(RecordedCommandType::PLACE);
+    command.timestamp = timestamp;
+    command.side = static_cast<uint8_t>(order.type);
+    command.timeInForce = static_cast<uint8_t>(order.timeInForce);
+    command.kind = static_cast<uint8_t>(order.kind);
+    command.owner = owner;
+    command.price = order.price;
+    command.quantity = order.quantity;
+    append(command);
+}
+
+void CommandRecorder::recordCancel(OrderId orderId, Timestamp timestamp) {
+    RecordedCommand command{};
+    command.type = static_cast<uint16_t>(RecordedCommandType::CANCEL);
+    command.timestamp = timestamp;
+    command.orderId = orderId;
+    append(command);
+}
+
+void CommandRecorder::recordModify(OrderId orderId, int price, int quantity, Timestamp timestamp) {
+    RecordedCommand command{};
+    command.type = static_cast<uint16_t>(RecordedCommandType::MODIFY);
+    command.timestamp = timestamp;
+    command.orderId = orderId;
+    command.price = price;
+    command.quantity = quantity;
+    append(command);
+}
+
+void CommandRecorder::recordMassCancel(const MassCancelFilter& filter, Timestamp timestamp) {
+    RecordedCommand command{};
+    command.type = static_cast<uint16_t>(RecordedCommandType::MASS_CANCEL);
+    command.timestamp = timestamp;
+    command.side = filter.side ? static_cast<uint8_t>(*filter.side) : kRecordedBothSides;
+    command.owner = filter.owner;
+    command.price = filter.minPrice;
+    command.quantity = filter.maxPrice;
+    append(command);
+}
+
+void CommandRecorder::append(RecordedCommand& command) {
+    command.sequence = ++sequence;
+    out.write(reinterpret_cast<const char*>(&command), sizeof(command));
+    // Handed to the OS before the book applies the command.
+    out.flush();
+}
+
+bool Recording::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) return false;
+
+    RecordingHeader fileHeader;
+    if (!in.read(reinterpret_cast<char*>(&fileHeader), sizeof(fileHeader)) ||
+        std::memcmp(fileHeader.magic, kMagic, sizeof(kMagic)) != 0) {
+        throw std::runtime_error("Not a command recording: " + path);
+    }
+    if (fileHeader.version != kVersion) {
+        throw std::runtime_error("Unsupported command recording version " + std::to_string(fileHeader.version) +
+                                 ": " + path);
+    }
+    header.tradesOffset = fileHeader.tradesOffset;
+    header.useLadder = (fileHeader.flags & kLadderFlag) != 0;
+    header.ladderMinPrice = fileHeader.ladderMinPrice;
+    header.ladderMaxPrice = fileHeader.ladderMaxPrice;
+
+    in.seekg(0, std::ios::end);
+    auto size = static_cast<std::size_t>(in.tellg());
+    records.resize((size - sizeof(fileHeader)) / sizeof(RecordedCommand));
+    in.seekg(sizeof(fileHeader));
+    in.read(reinterpret_cast<char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(RecordedCommand)));
+    return true;
+}
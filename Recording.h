@@ -0,0 +1,89 @@
+#ifndef RECORDING_H
+#define RECORDING_H
+
+#include "Order.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Kinds of inbound commands in a recording.
+enum class RecordedCommandType : uint16_t { PLACE = 1, CANCEL = 2, MODIFY = 3, MASS_CANCEL = 4 };
+
+// MASS_CANCEL side value for a cancel that covers both sides.
+constexpr uint8_t kRecordedBothSides = 2;
+
+// One inbound command exactly as the book received it, whether or not it was
+// accepted. Fields that a command type does not use are zero.
+struct RecordedCommand {
+    uint64_t sequence;   // 1, 2, 3, ... in the order the book received them
+    int64_t timestamp;   // the command's engine clock reading, nanoseconds since the epoch
+    uint16_t type;       // RecordedCommandType
+    uint8_t side;        // PLACE: OrderType; MASS_CANCEL: OrderType or kRecordedBothSides
+    uint8_t timeInForce; // PLACE
+    uint8_t kind;        // PLACE: OrderKind
+    uint8_t reserved;
+    uint16_t owner;      // PLACE: the order's owner; MASS_CANCEL: owner filter
+    int32_t price;       // PLACE/MODIFY: limit price; MASS_CANCEL: lowest price
+    int32_t quantity;    // PLACE/MODIFY: quantity; MASS_CANCEL: highest price
+    int64_t orderId;     // CANCEL/MODIFY: the order
+};
+static_assert(sizeof(RecordedCommand) == 40, "RecordedCommand is part of the on-disk format");
+
+// What a replay needs to know about the book the commands were recorded against.
+struct RecordingInfo {
+    // Bytes of trades.csv written before the first recorded command; the
+    // trades the recording produces follow them.
+    uint64_t tradesOffset = 0;
+    bool useLadder = false;
+    int32_t ladderMinPrice = 0;
+    int32_t ladderMaxPrice = 0;
+};
+
+// Appends every inbound command of one OrderBook session to a binary file, so
+// that the session can be replayed exactly (see replay.cpp). Each command is
+// written before the book applies it, so a command that brings the engine down
+// is still in the recording. Opening a recorder starts a new recording.
+//
+// A recording covers the commands only. The book it starts from goes beside it
+// as a snapshot, in snapshotPath().
+class CommandRecorder {
+public:
+    CommandRecorder(const std::string& path, const RecordingInfo& info);
+
+    void recordPlace(const Order& order, uint16_t owner, Timestamp timestamp);
+    void recordCancel(OrderId orderId, Timestamp timestamp);
+    void recordModify(OrderId orderId, int price, int quantity, Timestamp timestamp);
+    void recordMassCancel(const MassCancelFilter& filter, Timestamp timestamp);
+
+    // Commands recorded so far.
+    uint64_t count() const { return sequence; }
+
+    // Where the snapshot of the starting book belongs for a recording at path.
+    static std::string snapshotPath(const std::string& path) { return path + ".snapshot"; }
+
+private:
+    std::ofstream out;
+    uint64_t sequence = 0;
+
+    void append(RecordedCommand& command);
+};
+
+// A recording read back for replay.
+class Recording {
+public:
+    // Reads the recording at path. Returns false if it cannot be opened; throws
+    // if it is not a recording. A torn last command is ignored.
+    bool load(const std::string& path);
+
+    const RecordingInfo& info() const { return header; }
+    const std::vector<RecordedCommand>& commands() const { return records; }
+
+private:
+    RecordingInfo header;
+    std::vector<RecordedCommand> records;
+};
+
+#endif // RECORDING_H
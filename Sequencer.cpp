@@ -0,0 +1,81 @@
+#include "Sequencer.h"
+
+#include <chrono>
+#include <stdexcept>
+
+Sequencer::Sequencer(OrderBook& book, const SequencerConfig& config)
+    : book(book), config(config), inbound(config.inboundCapacity), producers(config.maxProducers) {
+    matcher = std::thread(&Sequencer::run, this);
+}
+
+Sequencer::~Sequencer() {
+    stopping.store(true, std::memory_order_release);
+    if (matcher.joinable()) matcher.join();
+}
+
+Sequencer::Producer& Sequencer::connect() {
+    std::size_t id = producerCount.fetch_add(1, std::memory_order_relaxed);
+    if (id >= producers.size() || id >= UINT16_MAX) {
+        producerCount.fetch_sub(1, std::memory_order_relaxed);
+        throw std::length_error("Too many sequencer producers");
+    }
+    producers[id].reset(new Producer(static_cast<uint16_t>(id), &inbound, config.responseCapacity));
+    return *producers[id];
+}
+
+void Sequencer::run() {
+    std::vector<SequencerCommand> batch(config.batchSize > 0 ? config.batchSize : 1);
+    unsigned idle = 0;
+    while (true) {
+        std::size_t n = inbound.popBatch(batch.data(), batch.size());
+        if (n == 0) {
+            // Only stop once the ring is empty, so nothing already queued is lost.
+            if (stopping.load(std::memory_order_acquire)) break;
+            // Spin briefly for the next command, then back off so an idle
+            // matching thread does not hold its core.
+            if (++idle < 1024) continue;
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+            continue;
+        }
+        idle = 0;
+        for (std::size_t i = 0; i < n; ++i) apply(batch[i]);
+    }
+}
+
+void Sequencer::apply(const SequencerCommand& command) {
+    SequencerResponse response;
+    response.sequence = applied.load(std::memory_order_relaxed) + 1;
+    response.tag = command.tag;
+    try {
+        uint16_t owner = producers[command.producer]->owner();
+        if (command.kind == SequencerCommand::Kind::PLACE && command.orderKind == OrderKind::MARKET) {
+            response.orderId = book.placeMarketOrder(command.side, command.quantity, command.timeInForce, owner);
+        } else if (command.kind == SequencerCommand::Kind::PLACE) {
+            response.orderId =
+                book.placeOrder(command.side, command.price, command.quantity, command.timeInForce, owner);
+        } else if (command.kind == SequencerCommand::Kind::MODIFY) {
+            response.orderId = command.orderId;
+            book.modifyOrder(command.orderId, command.price, command.quantity);
+        } else if (command.kind == SequencerCommand::Kind::MASS_CANCEL) {
+            MassCancelFilter filter;
+            if (!command.bothSides) filter.side = command.side;
+            filter.minPrice = command.price;
+            if (command.quantity > 0) filter.maxPrice = command.quantity;
+            filter.owner = owner;
+            response.cancelled = book.massCancel(filter);
+        } else {
+            response.orderId = command.orderId;
+            book.cancelOrder(command.orderId);
+        }
+        response.accepted = true;
+    } catch (const std::exception&) {
+        // The book has already logged why; the producer learns from accepted = false.
+        response.accepted = false;
+    }
+    applied.store(response.sequence, std::memory_order_release);
+
+    // Waiting here for a producer that has stopped reading its responses would
+    // hold up every other producer, so its response is dropped instead.
+    Producer& producer = *producers[command.producer];
+    if (!producer.responses.tryPush(response)) producer.dropped.fetch_add(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,123 @@
+#ifndef SEQUENCER_H
+#define SEQUENCER_H
+
+#include "OrderBook.h"
+#include "MpscRing.h"
+#include "SpscRing.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+struct SequencerConfig {
+    std::size_t inboundCapacity = 1 << 16; // commands waiting for the matching thread
+    std::size_t responseCapacity = 1 << 14; // responses waiting for each producer
+    std::size_t maxProducers = 64;
+    std::size_t batchSize = 256; // commands applied per drain of the inbound ring
+};
+
+// A fixed-size order, cancel, modify or mass cancel, as sent by a producer.
+// Orders are placed with the producer's owner id, and a mass cancel only
+// removes orders of that owner, so a gateway can pull its own session's orders.
+struct SequencerCommand {
+    enum class Kind : uint8_t { PLACE, CANCEL, MODIFY, MASS_CANCEL };
+    Kind kind = Kind::PLACE;
+    OrderKind orderKind = OrderKind::LIMIT;          // PLACE only; MARKET ignores price
+    TimeInForce timeInForce = TimeInForce::GTC;      // PLACE only
+    OrderType side = OrderType::BUY;
+    bool bothSides = false; // MASS_CANCEL only; ignores side
+    uint16_t producer = 0; // filled in by Sequencer::Producer
+    int price = 0;    // PLACE and MODIFY; MASS_CANCEL: the lowest price
+    int quantity = 0; // PLACE and MODIFY (the new total quantity); MASS_CANCEL: the highest price, 0 for no limit
+    OrderId orderId = 0; // CANCEL and MODIFY only
+    uint64_t tag = 0; // echoed back in the response
+};
+
+// The outcome of one command, in the order the producer's commands were applied.
+struct SequencerResponse {
+    uint64_t sequence = 0; // global order in which the matching thread applied commands
+    uint64_t tag = 0;
+    OrderId orderId = 0;   // the new order's id for PLACE, the target's id for CANCEL and MODIFY
+    uint64_t cancelled = 0; // MASS_CANCEL: how many orders it removed
+    bool accepted = false; // false if the book rejected the command
+};
+
+// Single-writer front end for an OrderBook. Producer threads push commands into
+// one lock-free multi-producer ring; a single matching thread drains it in
+// batches, stamps each command with the next sequence number, applies it to the
+// book and answers through the producer's own response ring. The book is only
+// ever touched by the matching thread, so it needs no lock however many
+// producers there are. The matching thread never waits on a producer: if one
+// falls responseCapacity responses behind, further responses to it are dropped
+// and counted until it catches up.
+class Sequencer {
+public:
+    // One producer's handle. A handle must be used by one thread at a time.
+    class Producer {
+    public:
+        // Queues a command. Returns false if the inbound ring is full.
+        bool trySubmit(SequencerCommand command) {
+            command.producer = id;
+            return inbound->tryPush(command);
+        }
+
+        // Queues a command, waiting for room in the inbound ring.
+        void submit(const SequencerCommand& command) {
+            while (!trySubmit(command)) std::this_thread::yield();
+        }
+
+        // Takes the next response, if one is ready.
+        bool poll(SequencerResponse& response) { return responses.tryPop(response); }
+
+        // The owner id this producer's orders carry in the book (never 0, which
+        // massCancel takes as any owner).
+        uint16_t owner() const { return static_cast<uint16_t>(id + 1); }
+
+        // Responses thrown away because this producer's response ring was full.
+        // The commands themselves were still applied.
+        uint64_t droppedResponses() const { return dropped.load(std::memory_order_relaxed); }
+
+    private:
+        friend class Sequencer;
+        Producer(uint16_t id, MpscRing<SequencerCommand>* inbound, std::size_t capacity)
+            : id(id), inbound(inbound), responses(capacity) {}
+
+        uint16_t id;
+        MpscRing<SequencerCommand>* inbound;
+        SpscRing<SequencerResponse> responses;
+        std::atomic<uint64_t> dropped{0};
+    };
+
+    // The book must outlive the sequencer and must not be used directly while it runs.
+    explicit Sequencer(OrderBook& book, const SequencerConfig& config = SequencerConfig());
+    // Applies every command already queued, then stops the matching thread.
+    ~Sequencer();
+
+    Sequencer(const Sequencer&) = delete;
+    Sequencer& operator=(const Sequencer&) = delete;
+
+    // Registers a new producer. Safe to call from any thread, up to maxProducers
+    // times (and at most 65534, the number of owner ids).
+    Producer& connect();
+
+    // Commands applied so far.
+    uint64_t sequence() const { return applied.load(std::memory_order_acquire); }
+
+private:
+    void run();
+    void apply(const SequencerCommand& command);
+
+    OrderBook& book;
+    SequencerConfig config;
+    MpscRing<SequencerCommand> inbound;
+    std::vector<std::unique_ptr<Producer>> producers; // sized up front, filled by connect()
+    std::atomic<std::size_t> producerCount{0};
+    alignas(64) std::atomic<uint64_t> applied{0};
+    std::atomic<bool> stopping{false};
+    std::thread matcher;
+};
+
+#endif // SEQUENCER_H
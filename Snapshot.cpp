@@ -0,0 +1,170 @@
+#include "Snapshot.h"
+#include "OrderPool.h"
+
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr char kMagic[8] = {'O', 'M', 'E', 'S', 'N', 'A', 'P', '1'};
+constexpr uint32_t kVersion = 3;
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t orderCount;
+    int64_t nextOrderId;
+    int64_t nextTradeId;
+    uint64_t journalSequence;
+    uint64_t checksum; // over this header (with checksum zeroed) and the order records
+};
+static_assert(sizeof(SnapshotHeader) == 56, "SnapshotHeader is part of the on-disk format");
+
+constexpr uint64_t kChecksumSeed = 0xcbf29ce484222325ull;
+
+// FNV-1a over 64-bit words: cheap enough to run over millions of records at
+// startup. Continue a running checksum by passing it back in as hash.
+uint64_t checksum(const void* data, std::size_t size, uint64_t hash = kChecksumSeed) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, bytes + i, sizeof(word));
+        hash = (hash ^ word) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+template <typename TBook>
+void appendSide(std::vector<SnapshotOrder>& out, const TBook& book) {
+    book.forEachLevel([&](int, const PriceLevel& level) {
+        for (const Order* o = level.head; o; o = o->next) {
+            const OrderInfo& info = OrderPool::info(o);
+            out.push_back(SnapshotOrder{o->id, static_cast<uint32_t>(o->type), o->price, o->quantity,
+                                        o->filled_quantity, info.owner, 0, info.timestamp});
+        }
+        return true;
+    });
+}
+
+void writeAll(int fd, const void* data, std::size_t size, const std::string& path) {
+    const char* p = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t written = ::write(fd, p, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            ::close(fd);
+            throw std::runtime_error("Failed to write snapshot: " + path);
+        }
+        p += written;
+        size -= static_cast<std::size_t>(written);
+    }
+}
+
+} // namespace
+
+Snapshot::~Snapshot() {
+    if (mapping) ::munmap(mapping, mappingSize);
+}
+
+void Snapshot::write(const std::string& path, const BuyBook& buyOrders, const SellBook& sellOrders,
+                     const SnapshotState& state) {
+    std::vector<SnapshotOrder> orders;
+    appendSide(orders, buyOrders);
+    appendSide(orders, sellOrders);
+
+    SnapshotHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.headerSize = sizeof(SnapshotHeader);
+    header.orderCount = orders.size();
+    header.nextOrderId = state.nextOrderId;
+    header.nextTradeId = state.nextTradeId;
+    header.journalSequence = state.journalSequence;
+    header.checksum = 0;
+    header.checksum = checksum(orders.data(), orders.size() * sizeof(SnapshotOrder), checksum(&header, sizeof(header)));
+
+    std::string tmp = path + ".tmp";
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to create snapshot: " + tmp);
+    }
+    writeAll(fd, &header, sizeof(header), tmp);
+    writeAll(fd, orders.data(), orders.size() * sizeof(SnapshotOrder), tmp);
+    if (::fsync(fd) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Failed to sync snapshot: " + tmp);
+    }
+    if (::close(fd) != 0) {
+        throw std::runtime_error("Failed to close snapshot: " + tmp);
+    }
+
+    if (::rename(tmp.c_str(), path.c_str()) != 0) {
+        throw std::runtime_error("Failed to install snapshot: " + path);
+    }
+    // The rename is only durable once the directory is: until then a power loss
+    // can bring back the old snapshot after the journal has moved past it.
+    std::string dir = std::filesystem::path(path).parent_path().string();
+    if (dir.empty()) dir = ".";
+    int dirFd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (dirFd < 0) {
+        throw std::runtime_error("Failed to open snapshot directory: " + dir);
+    }
+    int synced = ::fsync(dirFd);
+    ::close(dirFd);
+    if (synced != 0) {
+        throw std::runtime_error("Failed to sync snapshot directory: " + dir);
+    }
+}
+
+bool Snapshot::load(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(SnapshotHeader)) {
+        ::close(fd);
+        throw std::runtime_error("Snapshot is truncated: " + path);
+    }
+    mappingSize = static_cast<std::size_t>(st.st_size);
+    mapping = ::mmap(nullptr, mappingSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        mapping = nullptr;
+        throw std::runtime_error("Failed to map snapshot: " + path);
+    }
+    ::madvise(mapping, mappingSize, MADV_SEQUENTIAL);
+
+    SnapshotHeader header;
+    std::memcpy(&header, mapping, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+        header.headerSize != sizeof(SnapshotHeader)) {
+        throw std::runtime_error("Not a supported snapshot: " + path);
+    }
+    std::size_t bytes = header.orderCount * sizeof(SnapshotOrder);
+    if (mappingSize != sizeof(SnapshotHeader) + bytes) {
+        throw std::runtime_error("Snapshot size does not match its header: " + path);
+    }
+
+    const char* body = static_cast<const char*>(mapping) + sizeof(SnapshotHeader);
+    // The ids and counters are covered too, not just the orders.
+    SnapshotHeader zeroed = header;
+    zeroed.checksum = 0;
+    if (checksum(body, bytes, checksum(&zeroed, sizeof(zeroed))) != header.checksum) {
+        throw std::runtime_error("Snapshot checksum mismatch: " + path);
+    }
+
+    count = header.orderCount;
+    records = reinterpret_cast<const SnapshotOrder*>(body);
+    loadedState.nextOrderId = header.nextOrderId;
+    loadedState.nextTradeId = header.nextTradeId;
+    loadedState.journalSequence = header.journalSequence;
+    return true;
+}
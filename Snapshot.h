@@ -0,0 +1,67 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "Order.h"
+#include "BookSide.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Counters that have to survive a restart along with the resting orders.
+struct SnapshotState {
+    OrderId nextOrderId = 1;
+    int64_t nextTradeId = 1;
+    // Journal sequence number of the first event not reflected in the snapshot.
+    uint64_t journalSequence = 0;
+};
+
+// One resting order as stored in a snapshot file.
+struct SnapshotOrder {
+    int64_t id;
+    uint32_t side; // OrderType
+    int32_t price;
+    int32_t quantity;
+    int32_t filled;
+    int32_t owner;
+    uint32_t reserved;
+    int64_t timestamp; // nanoseconds since the epoch
+};
+static_assert(sizeof(SnapshotOrder) == 40, "SnapshotOrder is part of the on-disk format");
+
+// A versioned, checksummed binary image of the whole book. Orders are stored
+// side by side in priority order (best level first, FIFO within a level), so
+// loading them back in file order recreates every queue exactly.
+//
+// The checksum covers the header's ids and counters as well as the orders.
+// Loading maps the file read-only and hands out the records in place.
+class Snapshot {
+public:
+    Snapshot() = default;
+    ~Snapshot();
+
+    Snapshot(const Snapshot&) = delete;
+    Snapshot& operator=(const Snapshot&) = delete;
+
+    // Writes the book to path atomically and durably (temporary file, fsync,
+    // rename, fsync of the directory). Throws if any step fails.
+    static void write(const std::string& path, const BuyBook& buyOrders, const SellBook& sellOrders,
+                      const SnapshotState& state);
+
+    // Maps and validates the snapshot at path. Returns false if there is no
+    // snapshot; throws if the file exists but is damaged or of an unknown version.
+    bool load(const std::string& path);
+
+    const SnapshotState& state() const { return loadedState; }
+    std::size_t orderCount() const { return count; }
+    const SnapshotOrder* orders() const { return records; }
+
+private:
+    void* mapping = nullptr;
+    std::size_t mappingSize = 0;
+    SnapshotState loadedState;
+    const SnapshotOrder* records = nullptr;
+    std::size_t count = 0;
+};
+
+#endif // SNAPSHOT_H
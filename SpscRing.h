@@ -0,0 +1,60 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+// Bounded single-producer/single-consumer queue of fixed-size items. One thread
+// may push and one (other) thread may pop; neither ever takes a lock. Each side
+// caches the other side's index and only re-reads it when the ring looks full
+// (or empty), so the shared cache lines are touched once per batch, not per item.
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(std::size_t capacity) {
+        std::size_t size = 2;
+        while (size < capacity) size <<= 1;
+        slots.reset(new T[size]);
+        mask = size - 1;
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Producer side. Returns false if the ring is full.
+    bool tryPush(const T& item) {
+        std::size_t h = head.load(std::memory_order_relaxed);
+        if (h - cachedTail > mask) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h - cachedTail > mask) return false;
+        }
+        slots[h & mask] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Returns false if the ring is empty.
+    bool tryPop(T& item) {
+        std::size_t t = tail.load(std::memory_order_relaxed);
+        if (t == cachedHead) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (t == cachedHead) return false;
+        }
+        item = slots[t & mask];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    std::size_t capacity() const { return mask + 1; }
+
+private:
+    std::unique_ptr<T[]> slots;
+    std::size_t mask = 0;
+    alignas(64) std::atomic<std::size_t> head{0}; // next slot the producer fills
+    std::size_t cachedTail = 0;                   // producer's view of tail
+    alignas(64) std::atomic<std::size_t> tail{0}; // next slot the consumer reads
+    std::size_t cachedHead = 0;                   // consumer's view of head
+};
+
+#endif // SPSC_RING_H
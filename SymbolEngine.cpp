@@ -0,0 +1,224 @@
+#include "SymbolEngine.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <pthread.h>
+#include <sched.h>
+
+namespace {
+
+// Symbols double as directory names, so keep them to a safe character set.
+bool validSymbol(const std::string& symbol) {
+    if (symbol.empty() || symbol.size() > SymbolEngine::kMaxSymbolLength || symbol[0] == '.') return false;
+    return std::all_of(symbol.begin(), symbol.end(), [](unsigned char c) {
+        return std::isalnum(c) || c == '.' || c == '_' || c == '-';
+    });
+}
+
+OrderBook& bookAt(std::vector<std::unique_ptr<OrderBook>>& books, uint32_t index) {
+    if (!books[index]) {
+        throw std::runtime_error("This symbol's book failed to open");
+    }
+    return *books[index];
+}
+
+void pinToCore(unsigned core) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(core, &cpus);
+    int rc = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    if (rc != 0) {
+        std::cerr << "Warning: could not pin worker to core " << core << ": " << std::strerror(rc) << std::endl;
+    }
+}
+
+} // namespace
+
+SymbolEngine::SymbolEngine(const SymbolEngineConfig& config) : config(config) {
+    std::filesystem::create_directories(config.dataDir);
+
+    unsigned count = std::max(1u, config.workers);
+    workers.reserve(count);
+    for (unsigned i = 0; i < count; ++i) {
+        workers.push_back(std::make_unique<Worker>(config.queueCapacity));
+    }
+    for (unsigned i = 0; i < count; ++i) {
+        workers[i]->thread = std::thread(&SymbolEngine::runWorker, this, i);
+    }
+
+    // Reopen the books of earlier runs, in name order so they land on the same workers.
+    std::vector<std::string> existing;
+    for (const auto& entry : std::filesystem::directory_iterator(config.dataDir)) {
+        std::string name = entry.path().filename().string();
+        if (entry.is_directory() && validSymbol(name)) existing.push_back(name);
+    }
+    std::sort(existing.begin(), existing.end());
+    for (const auto& symbol : existing) route(symbol);
+}
+
+SymbolEngine::~SymbolEngine() {
+    broadcast(Command::Kind::STOP);
+    for (auto& worker : workers) {
+        if (worker->thread.joinable()) worker->thread.join();
+    }
+}
+
+void SymbolEngine::placeOrder(const std::string& symbol, OrderType type, int price, int quantity) {
+    const Route& r = route(symbol);
+    Command command;
+    command.kind = Command::Kind::PLACE;
+    command.side = type;
+    command.book = r.book;
+    command.price = price;
+    command.quantity = quantity;
+    submit(r.worker, command);
+}
+
+void SymbolEngine::cancelOrder(const std::string& symbol, OrderId id) {
+    auto it = routes.find(symbol);
+    if (it == routes.end()) {
+        throw std::invalid_argument("Unknown symbol: " + symbol);
+    }
+    Command command;
+    command.kind = Command::Kind::CANCEL;
+    command.book = it->second.book;
+    command.id = id;
+    submit(it->second.worker, command);
+}
+
+void SymbolEngine::showBook(const std::string& symbol) {
+    auto it = routes.find(symbol);
+    if (it == routes.end()) {
+        throw std::invalid_argument("Unknown symbol: " + symbol);
+    }
+    Command command;
+    command.kind = Command::Kind::SHOW;
+    command.book = it->second.book;
+    submit(it->second.worker, command);
+}
+
+void SymbolEngine::exportBooks() { broadcast(Command::Kind::EXPORT); }
+
+void SymbolEngine::takeSnapshots() { broadcast(Command::Kind::SNAPSHOT); }
+
+void SymbolEngine::sync() {
+    for (auto& worker : workers) {
+        while (worker->applied.load(std::memory_order_acquire) < worker->submitted) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+// Finds the worker and book slot for a symbol, assigning new symbols to the
+// next worker in turn and telling it to open the book.
+const SymbolEngine::Route& SymbolEngine::route(const std::string& symbol) {
+    auto it = routes.find(symbol);
+    if (it != routes.end()) return it->second;
+
+    if (!validSymbol(symbol)) {
+        throw std::invalid_argument("Invalid symbol: " + symbol);
+    }
+    uint32_t worker = nextWorker;
+    nextWorker = (nextWorker + 1) % workers.size();
+    Route r{worker, workers[worker]->bookCount++};
+
+    Command command;
+    command.kind = Command::Kind::OPEN;
+    command.book = r.book;
+    std::memcpy(command.symbol, symbol.data(), symbol.size());
+    submit(worker, command);
+
+    return routes.emplace(symbol, r).first->second;
+}
+
+void SymbolEngine::submit(uint32_t index, const Command& command) {
+    Worker& worker = *workers[index];
+    while (!worker.inbox.tryPush(command)) {
+        std::this_thread::yield();
+    }
+    ++worker.submitted;
+}
+
+void SymbolEngine::broadcast(Command::Kind kind) {
+    Command command;
+    command.kind = kind;
+    for (uint32_t i = 0; i < workers.size(); ++i) submit(i, command);
+}
+
+void SymbolEngine::runWorker(unsigned index) {
+    if (config.pinWorkers) {
+        pinToCore(index % std::max(1u, std::thread::hardware_concurrency()));
+    }
+    Worker& worker = *workers[index];
+
+    // The logger and the books are created, used and destroyed on this thread only.
+    LoggerOptions loggerOptions = config.logger;
+    if (!loggerOptions.binaryLogFile.empty()) {
+        loggerOptions.binaryLogFile = config.dataDir + "/events-" + std::to_string(index) + ".bin";
+    }
+    auto logger = std::make_shared<Logger>(config.dataDir + "/events-" + std::to_string(index) + ".log", loggerOptions);
+    std::vector<std::unique_ptr<OrderBook>> books;
+
+    Command command;
+    unsigned idle = 0;
+    while (true) {
+        if (!worker.inbox.tryPop(command)) {
+            // Spin briefly for the next command, then back off so an idle
+            // worker does not hold its core.
+            if (++idle < 1024) continue;
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+            continue;
+        }
+        idle = 0;
+
+        try {
+            switch (command.kind) {
+                case Command::Kind::OPEN: {
+                    OrderBookConfig bookConfig = config.book;
+                    bookConfig.dataDir = config.dataDir + "/" + command.symbol;
+                    // Relative shared-file paths already land in the symbol's directory; absolute ones need their own names.
+                    for (std::string* file : {&bookConfig.marketDataFile, &bookConfig.depthFile}) {
+                        if (!file->empty() && (*file)[0] == '/') *file += std::string(".") + command.symbol;
+                    }
+                    // Keep the slot even if the book fails to open, so later indices stay right.
+                    books.emplace_back();
+                    logger->log("System", std::string("Opening book for ") + command.symbol);
+                    std::filesystem::create_directories(bookConfig.dataDir);
+                    books.back() = std::make_unique<OrderBook>(logger, bookConfig);
+                    break;
+                }
+                case Command::Kind::PLACE:
+                    bookAt(books, command.book).placeOrder(command.side, command.price, command.quantity);
+                    break;
+                case Command::Kind::CANCEL:
+                    bookAt(books, command.book).cancelOrder(command.id);
+                    break;
+                case Command::Kind::SHOW:
+                    bookAt(books, command.book).showBook();
+                    break;
+                case Command::Kind::EXPORT:
+                    for (auto& book : books) {
+                        if (book) book->exportBook();
+                    }
+                    break;
+                case Command::Kind::SNAPSHOT:
+                    for (auto& book : books) {
+                        if (book) book->takeSnapshot();
+                    }
+                    break;
+                case Command::Kind::STOP:
+                    books.clear();
+                    worker.applied.fetch_add(1, std::memory_order_release);
+                    return;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+        }
+        worker.applied.fetch_add(1, std::memory_order_release);
+    }
+}
@@ -0,0 +1,107 @@
+#ifndef SYMBOL_ENGINE_H
+#define SYMBOL_ENGINE_H
+
+#include "OrderBook.h"
+#include "Logger.h"
+#include "SpscRing.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+struct SymbolEngineConfig {
+    // Worker threads; each one owns the books of its symbols outright.
+    unsigned workers = 1;
+    // Pin worker i to core i (modulo the number of cores).
+    bool pinWorkers = true;
+    // Each symbol keeps its files in dataDir/SYMBOL/. Books found there are
+    // opened (and recovered) at start-up.
+    std::string dataDir = "symbols";
+    // Commands that can be queued for one worker before submitting blocks.
+    std::size_t queueCapacity = 1 << 14;
+
+    // Settings for every book (dataDir is filled in per symbol) and for the
+    // per-worker loggers (events-N.log / events-N.bin in dataDir).
+    OrderBookConfig book;
+    LoggerOptions logger;
+};
+
+// Hosts one OrderBook per instrument. Symbols are dealt out round-robin to the
+// worker threads in the order they are first seen, and a book is only ever
+// touched by its worker, so matching takes no locks. The calling thread routes
+// each command to its symbol's worker through a single-producer ring.
+//
+// All member functions must be called from one thread. Commands are applied
+// asynchronously; errors and book output are printed by the workers.
+class SymbolEngine {
+public:
+    static constexpr std::size_t kMaxSymbolLength = 15;
+
+    explicit SymbolEngine(const SymbolEngineConfig& config = SymbolEngineConfig());
+    // Stops the workers; each one exports and snapshots its books on the way out.
+    ~SymbolEngine();
+
+    SymbolEngine(const SymbolEngine&) = delete;
+    SymbolEngine& operator=(const SymbolEngine&) = delete;
+
+    // Routes an order to its symbol's book, opening the book on first use.
+    void placeOrder(const std::string& symbol, OrderType type, int price, int quantity);
+
+    // Cancels an order on a symbol's book. Order ids are per symbol.
+    void cancelOrder(const std::string& symbol, OrderId id);
+
+    void showBook(const std::string& symbol);
+    void exportBooks();
+    void takeSnapshots();
+
+    // Waits until every command submitted so far has been applied.
+    void sync();
+
+    std::size_t symbolCount() const { return routes.size(); }
+    unsigned workerCount() const { return static_cast<unsigned>(workers.size()); }
+
+private:
+    // A fixed-size command in a worker's inbox.
+    struct Command {
+        enum class Kind : uint8_t { OPEN, PLACE, CANCEL, SHOW, EXPORT, SNAPSHOT, STOP };
+        Kind kind = Kind::STOP;
+        OrderType side = OrderType::BUY;
+        uint32_t book = 0; // index into the worker's books
+        int price = 0;
+        int quantity = 0;
+        OrderId id = 0;
+        char symbol[kMaxSymbolLength + 1] = {}; // OPEN only
+    };
+
+    struct Worker {
+        explicit Worker(std::size_t capacity) : inbox(capacity) {}
+
+        SpscRing<Command> inbox;
+        uint64_t submitted = 0;               // routing thread only
+        alignas(64) std::atomic<uint64_t> applied{0};
+        uint32_t bookCount = 0;               // routing thread's count of opened books
+        std::thread thread;
+    };
+
+    struct Route {
+        uint32_t worker;
+        uint32_t book;
+    };
+
+    const Route& route(const std::string& symbol);
+    void submit(uint32_t worker, const Command& command);
+    void broadcast(Command::Kind kind);
+    void runWorker(unsigned index);
+
+    SymbolEngineConfig config;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::unordered_map<std::string, Route> routes;
+    uint32_t nextWorker = 0;
+};
+
+#endif // SYMBOL_ENGINE_H
@@ -0,0 +1,60 @@
+"""Compare engine_bench JSON results against a stored baseline.
+
+Usage: python3 bench_compare.py BASELINE.json RESULTS.json [--threshold PCT]
+
+Prints the change in best-of-repeat ns/op for every benchmark present in both
+files and exits with status 1 if any got slower by more than the threshold
+(default 10%). The fastest repetition is compared rather than the median
+because it is the least disturbed by other load on the machine. Benchmarks
+missing from either file are listed but do not fail.
+"""
+import argparse
+import json
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        return {b["name"]: b for b in json.load(f)["benchmarks"]}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("baseline")
+    parser.add_argument("results")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="allowed slowdown in percent before a benchmark is flagged")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline)
+    results = load(args.results)
+
+    regressions = []
+    width = max((len(name) for name in results), default=0)
+    for name, result in results.items():
+        base = baseline.get(name)
+        if base is None:
+            print(f"{name:<{width}}  {result['min_ns_per_op']:>10.1f} ns/op  (new, no baseline)")
+            continue
+        before, after = base["min_ns_per_op"], result["min_ns_per_op"]
+        change = (after / before - 1.0) * 100.0 if before else 0.0
+        flag = ""
+        if change > args.threshold:
+            flag = "  REGRESSION"
+            regressions.append(name)
+        print(f"{name:<{width}}  {before:>10.1f} -> {after:>10.1f} ns/op  "
+              f"({change:+.1f}%){flag}")
+    for name in baseline:
+        if name not in results:
+            print(f"{name:<{width}}  missing from results")
+
+    if regressions:
+        print(f"\n{len(regressions)} benchmark(s) slower than the baseline by more than {args.threshold:g}%: "
+              + ", ".join(regressions))
+        return 1
+    print(f"\nNo benchmark slower than the baseline by more than {args.threshold:g}%.")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
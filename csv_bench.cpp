@@ -0,0 +1,115 @@
+// Measures how fast a CSV book loads with the mmap/from_chars importer compared
+// with the stringstream loader it replaced, and checks both read the same rows.
+//
+// Usage: csv_bench [orders.csv | -ROWS] [threads]
+//   With no file (or -ROWS) a synthetic book of ROWS orders (default 1000000)
+//   is written to csv_bench_orders.csv first. Build with optimisation
+//   (make CXXFLAGS="-std=c++17 -O2 -pthread") for meaningful figures.
+#include "CsvImport.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// The loader PersistenceManager used before the importer, kept as the baseline.
+void legacyLoad(const std::string& filename, OrderType type, std::vector<SavedOrder>& orders) {
+    std::ifstream in(filename);
+    std::string line;
+    getline(in, line); // skip header
+
+    while (getline(in, line)) {
+        if (line.empty()) continue;
+        std::stringstream ss(line);
+        std::string token;
+        SavedOrder saved;
+        Order& o = saved.order;
+        try {
+            getline(ss, token, ','); o.id = stoll(token);
+            getline(ss, token, ','); o.price = stoi(token);
+            getline(ss, token, ','); o.quantity = stoi(token);
+            getline(ss, token, ','); o.filled_quantity = stoi(token);
+            getline(ss, token, ','); saved.timestamp = stoll(token);
+            o.type = type;
+
+            orders.push_back(saved);
+        } catch (const std::exception& e) {
+            std::cerr << "Error parsing line in " << filename << ": " << line << " - " << e.what() << std::endl;
+        }
+    }
+}
+
+void writeSyntheticBook(const std::string& filename, long rows) {
+    std::ofstream out(filename);
+    out << "OrderID,Price,Quantity,FilledQuantity,Timestamp\n";
+    for (long i = 0; i < rows; ++i) {
+        // A few dozen orders per level, best price first, like an exported buy book.
+        out << i + 1 << ',' << 100000 - i / 40 << ',' << 1 + i % 500 << ',' << i % 7 << ','
+            << 1700000000000000000LL + i << '\n';
+    }
+}
+
+bool sameOrders(const std::vector<SavedOrder>& a, const std::vector<SavedOrder>& b) {
+    if (a.size() != b.size()) return false;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        const Order& x = a[i].order;
+        const Order& y = b[i].order;
+        if (x.id != y.id || x.price != y.price || x.quantity != y.quantity ||
+            x.filled_quantity != y.filled_quantity || a[i].timestamp != b[i].timestamp) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void report(const char* name, std::size_t bytes, std::size_t rows, double seconds) {
+    std::cout << name << ": " << rows << " rows in " << seconds * 1000 << " ms, "
+              << bytes / (1024.0 * 1024.0) / seconds << " MB/s" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string filename = "csv_bench_orders.csv";
+    if (argc > 1 && argv[1][0] != '-') {
+        filename = argv[1];
+    } else {
+        long rows = argc > 1 ? std::atol(argv[1] + 1) : 1000000;
+        writeSyntheticBook(filename, rows);
+    }
+    unsigned threads = argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : 4;
+
+    std::vector<SavedOrder> legacy;
+    auto start = std::chrono::steady_clock::now();
+    legacyLoad(filename, OrderType::BUY, legacy);
+    double legacySeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<SavedOrder> single;
+    CsvImporter importer(1);
+    if (!importer.importOrders(filename, OrderType::BUY, single)) {
+        std::cerr << "Failed to open " << filename << std::endl;
+        return 1;
+    }
+    CsvImportStats singleStats = importer.stats();
+
+    std::vector<SavedOrder> parallel;
+    CsvImporter parallelImporter(threads);
+    parallelImporter.importOrders(filename, OrderType::BUY, parallel);
+    CsvImportStats parallelStats = parallelImporter.stats();
+
+    report("stringstream loader", singleStats.bytes, legacy.size(), legacySeconds);
+    report("importer, 1 thread", singleStats.bytes, singleStats.rows, singleStats.seconds);
+    std::string name = "importer, " + std::to_string(threads) + " threads";
+    report(name.c_str(), parallelStats.bytes, parallelStats.rows, parallelStats.seconds);
+
+    if (!sameOrders(legacy, single) || !sameOrders(legacy, parallel)) {
+        std::cerr << "Importer results differ from the stringstream loader" << std::endl;
+        return 1;
+    }
+    return 0;
+}
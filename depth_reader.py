@@ -0,0 +1,88 @@
+"""Read the book depth the engine publishes with --depth FILE.
+
+The file holds a fixed layout (see DepthSnapshot.h) guarded by a seqlock:
+the sequence at offset 64 is odd while the engine is writing, so a reader
+copies the view and retries if the sequence was odd or moved meanwhile.
+
+Usage: python3 depth_reader.py FILE [interval_seconds]
+"""
+import mmap
+import struct
+import sys
+import time
+
+MAGIC = b"OMEDEPTH"
+SEQUENCE = struct.Struct("<Q")
+SEQUENCE_OFFSET = 64
+VIEW_OFFSET = 72
+VIEW_HEADER = struct.Struct("<QqiiII")
+LEVEL = struct.Struct("<iiq")
+
+
+class DepthReader:
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self._map = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+        magic, version, levels = struct.unpack_from("<8sII", self._map, 0)
+        if magic != MAGIC or version != 1:
+            raise ValueError(f"{path} is not a depth segment")
+        self.levels = levels
+        self._view_size = VIEW_HEADER.size + 2 * levels * LEVEL.size
+
+    def read(self):
+        """Return a consistent view as a dict; bids and asks are best first."""
+        while True:
+            before = SEQUENCE.unpack_from(self._map, SEQUENCE_OFFSET)[0]
+            if before & 1:
+                continue
+            raw = self._map[VIEW_OFFSET:VIEW_OFFSET + self._view_size]
+            if SEQUENCE.unpack_from(self._map, SEQUENCE_OFFSET)[0] == before:
+                break
+        commands, timestamp, last_price, last_quantity, bid_count, ask_count = VIEW_HEADER.unpack_from(raw, 0)
+
+        def side(start, count):
+            entries = []
+            for i in range(count):
+                price, orders, quantity = LEVEL.unpack_from(raw, start + i * LEVEL.size)
+                entries.append({"price": price, "quantity": quantity, "orders": orders})
+            return entries
+
+        bids = side(VIEW_HEADER.size, bid_count)
+        asks = side(VIEW_HEADER.size + self.levels * LEVEL.size, ask_count)
+        return {
+            "commands": commands,
+            "timestamp_ns": timestamp,
+            "last_trade": {"price": last_price, "quantity": last_quantity} if last_quantity else None,
+            "best_bid": bids[0] if bids else None,
+            "best_ask": asks[0] if asks else None,
+            "bids": bids,
+            "asks": asks,
+        }
+
+    def close(self):
+        self._map.close()
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__.strip().splitlines()[-1])
+        return 1
+    reader = DepthReader(sys.argv[1])
+    interval = float(sys.argv[2]) if len(sys.argv) > 2 else None
+    while True:
+        view = reader.read()
+        print(f"after {view['commands']} commands, last trade {view['last_trade']}")
+        for i in range(max(len(view["bids"]), len(view["asks"]))):
+            bid = view["bids"][i] if i < len(view["bids"]) else None
+            ask = view["asks"][i] if i < len(view["asks"]) else None
+            left = f"{bid['quantity']:>8} ({bid['orders']:>3}) {bid['price']:>8}" if bid else " " * 23
+            right = f"{ask['price']:<8} {ask['quantity']:<8} ({ask['orders']})" if ask else ""
+            print(f"{left} | {right}")
+        if interval is None:
+            return 0
+        time.sleep(interval)
+        print()
+
+
+if __name__ == "__main__":
+    sys.exit(main())
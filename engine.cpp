@@ -1,7 +1,6 @@
 // Enhanced Order Matching Engine with Status Tracking (C++)
 #include <iostream>
 #include <map>
-#include <queue>
 #include <unordered_map>
 #include <fstream>
 #include <sstream>
@@ -9,52 +8,27 @@
 #include <limits>
 #include <iomanip>
 #include <chrono>
+#include "Order.h"
+#include "MatchingEngine.h"
+#include "OrderPool.h"
 using namespace std;
 
-enum class OrderType { BUY, SELL };
-enum class OrderStatus { OPEN, PARTIAL, FILLED, CANCELLED };
-
-// Utility functions
-string statusToStr(OrderStatus status) {
-    switch (status) {
-        case OrderStatus::OPEN: return "OPEN";
-        case OrderStatus::PARTIAL: return "PARTIAL";
-        case OrderStatus::FILLED: return "FILLED";
-        case OrderStatus::CANCELLED: return "CANCELLED";
-        default: return "UNKNOWN";
-    }
-}
-
-string typeToStr(OrderType type) {
-    return type == OrderType::BUY ? "BUY" : "SELL";
-}
-
-struct Order {
-    int id;
-    OrderType type;
-    int price;
-    int quantity;
-    int filled_quantity = 0;
-    time_t timestamp;
-    
-    int remaining() const { return quantity - filled_quantity; }
-    bool is_filled() const { return remaining() == 0; }
-};
-
 class OrderBook {
 private:
-    int orderId = 0;
-    time_t time = 0;
-    int tradeId = 1;
+    OrderId orderId = 0;
+    Timestamp time = 0;
+    int64_t tradeId = 1;
     
-    // Order books - price => queue of orders
-    map<int, queue<Order>, greater<int>> buyOrders;  // descending for buys
-    map<int, queue<Order>> sellOrders;              // ascending for sells
+    // Order books - price levels of FIFOs linked through the orders themselves
+    BuyBook buyOrders;   // descending for buys
+    SellBook sellOrders; // ascending for sells
+    MatchingEngine matchingEngine;
     
     // Tracking structures
-    unordered_map<int, pair<int, OrderType>> idToPriceAndType;
-    unordered_map<int, OrderStatus> orderStatus;
-    unordered_map<int, queue<Order>*> idToOrderQueue; 
+    unordered_map<OrderId, pair<int, OrderType>> idToPriceAndType;
+    unordered_map<OrderId, OrderStatus> orderStatus;
+    OrderPool orderPool{1024}; // every order linked into a level comes from here
+    unordered_map<OrderId, Order*> restingOrders;
     
     // File handles
     ofstream logFile;
@@ -105,10 +79,11 @@ public:
         Order order{
             ++orderId,
             type,
+            TimeInForce::GTC,
+            OrderKind::LIMIT,
             price,
             quantity,
-            0,  // filled_quantity
-            getCurrentTimestamp()
+            0  // filled_quantity
         };
 
         idToPriceAndType[order.id] = {price, type};
@@ -119,11 +94,7 @@ public:
                 " @ " + to_string(price));
 
         try {
-            if (type == OrderType::BUY) {
-                matchBuy(order);
-            } else {
-                matchSell(order);
-            }
+            match(order);
         } catch (...) {
             orderStatus[order.id] = OrderStatus::CANCELLED;
             throw;
@@ -133,30 +104,28 @@ public:
         exportOrderStatus();
     }
 
-    void cancelOrder(int id) {
+    void cancelOrder(OrderId id) {
         if (idToPriceAndType.count(id) == 0) {
             logEvent("Error", "Cancel failed - order ID " + to_string(id) + " not found");
             throw runtime_error("Order ID not found");
         }
 
-        auto price = idToPriceAndType[id].first;
         auto type = idToPriceAndType[id].second;
         bool removed = false;
 
-        if (type == OrderType::BUY) {
-            auto& q = buyOrders[price];
-            removed = removeOrderFromQueue(q, id);
-            if (q.empty()) buyOrders.erase(price);
-        } else {
-            auto& q = sellOrders[price];
-            removed = removeOrderFromQueue(q, id);
-            if (q.empty()) sellOrders.erase(price);
+        auto resting = restingOrders.find(id);
+        if (resting != restingOrders.end()) {
+            Order* order = resting->second;
+            removed = type == OrderType::BUY ? buyOrders.remove(order) : sellOrders.remove(order);
+            if (removed) {
+                restingOrders.erase(resting);
+                orderPool.release(order);
+            }
         }
 
         if (removed) {
             orderStatus[id] = OrderStatus::CANCELLED;
             idToPriceAndType.erase(id);
-            idToOrderQueue.erase(id);
             logEvent("Order", "Cancelled order ID " + to_string(id));
             exportActiveOrders();
             exportOrderStatus();
@@ -167,146 +136,71 @@ public:
     }
 
 private:
-    // Matching engine core functions
-    void matchBuy(Order& buy) {
-        int originalQty = buy.quantity;
-        
-        for (auto it = sellOrders.begin(); it != sellOrders.end() && !buy.is_filled();) {
-            if (buy.price < it->first) break;
-            
-            auto& q = it->second;
-            while (!q.empty() && !buy.is_filled()) {
-                Order& sell = q.front();
-                int tradedQty = min(buy.remaining(), sell.remaining());
-                
-                // Execute trade
-                executeTrade(buy, sell, sell.price, tradedQty);
-                
-                // Update quantities
-                buy.filled_quantity += tradedQty;
-                sell.filled_quantity += tradedQty;
-                
-                // Handle sell order status
-                if (sell.is_filled()) {
-                    orderStatus[sell.id] = OrderStatus::FILLED;
-                    q.pop();
-                } else {
-                    orderStatus[sell.id] = OrderStatus::PARTIAL;
-                }
-            }
-            
-            if (q.empty()) {
-                it = sellOrders.erase(it);
+    // Matching engine core: the side-specialized loop shared with MatchingEngine.
+    void match(Order& order) {
+        // One reading of the clock for the order and every trade it makes.
+        Timestamp now = getCurrentTimestamp();
+        auto onTrade = [this](const Trade& trade, Order& resting) {
+            executeTrade(trade);
+
+            // Handle resting order status
+            if (resting.is_filled()) {
+                orderStatus[resting.id] = OrderStatus::FILLED;
+                restingOrders.erase(resting.id);
+                orderPool.release(&resting);
             } else {
-                ++it;
+                orderStatus[resting.id] = OrderStatus::PARTIAL;
             }
-        }
-        
-        // Handle remaining buy order
-        if (!buy.is_filled()) {
-            orderStatus[buy.id] = buy.filled_quantity > 0 ? 
-                OrderStatus::PARTIAL : OrderStatus::OPEN;
-            buyOrders[buy.price].push(buy);
-            idToOrderQueue[buy.id] = &buyOrders[buy.price];
+        };
+        if (order.type == OrderType::BUY) {
+            matchingEngine.matchBuyOrder(order, sellOrders, tradeId, now, onTrade);
         } else {
-            orderStatus[buy.id] = OrderStatus::FILLED;
-            idToPriceAndType.erase(buy.id);
+            matchingEngine.matchSellOrder(order, buyOrders, tradeId, now, onTrade);
         }
-    }
 
-    void matchSell(Order& sell) {
-        int originalQty = sell.quantity;
-        
-        for (auto it = buyOrders.begin(); it != buyOrders.end() && !sell.is_filled();) {
-            if (sell.price > it->first) break;
-            
-            auto& q = it->second;
-            while (!q.empty() && !sell.is_filled()) {
-                Order& buy = q.front();
-                int tradedQty = min(sell.remaining(), buy.remaining());
-                
-                // Execute trade
-                executeTrade(buy, sell, buy.price, tradedQty);
-                
-                // Update quantities
-                sell.filled_quantity += tradedQty;
-                buy.filled_quantity += tradedQty;
-                
-                // Handle buy order status
-                if (buy.is_filled()) {
-                    orderStatus[buy.id] = OrderStatus::FILLED;
-                    q.pop();
-                } else {
-                    orderStatus[buy.id] = OrderStatus::PARTIAL;
-                }
-            }
-            
-            if (q.empty()) {
-                it = buyOrders.erase(it);
+        // Handle remaining incoming order
+        if (!order.is_filled()) {
+            orderStatus[order.id] = order.filled_quantity > 0 ? 
+                OrderStatus::PARTIAL : OrderStatus::OPEN;
+            Order* resting = orderPool.acquire(order, now);
+            restingOrders.emplace(order.id, resting);
+            if (order.type == OrderType::BUY) {
+                buyOrders.push_back(resting);
             } else {
-                ++it;
+                sellOrders.push_back(resting);
             }
-        }
-        
-        // Handle remaining sell order
-        if (!sell.is_filled()) {
-            orderStatus[sell.id] = sell.filled_quantity > 0 ? 
-                OrderStatus::PARTIAL : OrderStatus::OPEN;
-            sellOrders[sell.price].push(sell);
-            idToOrderQueue[sell.id] = &sellOrders[sell.price];
         } else {
-            orderStatus[sell.id] = OrderStatus::FILLED;
-            idToPriceAndType.erase(sell.id);
+            orderStatus[order.id] = OrderStatus::FILLED;
+            idToPriceAndType.erase(order.id);
         }
     }
 
-    void executeTrade(Order& buy, Order& sell, int price, int quantity) {
+    // Utility functions
+    void executeTrade(const Trade& trade) {
         // Log the trade
-        logFile << tradeId++ << ","
-                << buy.id << ","
-                << sell.id << ","
-                << price << ","
-                << quantity << ","
-                << getCurrentTimestamp() << "\n";
+        logFile << trade.tradeId << ","
+                << trade.buyOrderId << ","
+                << trade.sellOrderId << ","
+                << trade.price << ","
+                << trade.quantity << ","
+                << trade.timestamp << "\n";
         logFile.flush();
         
         // Log event
-        logEvent("Trade", "Matched " + to_string(quantity) + 
-                " units at price " + to_string(price) + 
-                " (Buy:" + to_string(buy.id) + 
-                " Sell:" + to_string(sell.id) + ")");
-        
-        cout << "Matched " << quantity << " units at price " << price << endl;
-    }
-
-    // Utility functions
-    bool removeOrderFromQueue(queue<Order>& q, int id) {
-        queue<Order> newQ;
-        bool found = false;
-        
-        while (!q.empty()) {
-            Order o = q.front();
-            q.pop();
-            if (o.id != id) {
-                newQ.push(o);
-            } else {
-                found = true;
-            }
-        }
-        
-        if (!newQ.empty()) {
-            q = move(newQ);
-        }
+        logEvent("Trade", "Matched " + to_string(trade.quantity) + 
+                " units at price " + to_string(trade.price) + 
+                " (Buy:" + to_string(trade.buyOrderId) + 
+                " Sell:" + to_string(trade.sellOrderId) + ")");
         
-        return found;
+        cout << "Matched " << trade.quantity << " units at price " << trade.price << endl;
     }
 
-    time_t getCurrentTimestamp() {
-        return chrono::system_clock::to_time_t(chrono::system_clock::now());
+    Timestamp getCurrentTimestamp() {
+        return chrono::duration_cast<chrono::nanoseconds>(chrono::system_clock::now().time_since_epoch()).count();
     }
 
     void logEvent(const string& category, const string& message) {
-        time_t now = getCurrentTimestamp();
+        time_t now = chrono::system_clock::to_time_t(chrono::system_clock::now());
         eventLog << put_time(localtime(&now), "%Y-%m-%d %H:%M:%S") << " ["
                 << category << "] " << message << "\n";
         eventLog.flush();
@@ -322,34 +216,13 @@ private:
             auto status = it->second;
 
             if (idToPriceAndType.count(id)) {
-                auto price = idToPriceAndType[id].first;
-                auto type = idToPriceAndType[id].second;
                 int filled = 0;
                 int total = 0;
                 
-                // Find the order to get filled quantity
-                if (type == OrderType::BUY && buyOrders.count(price)) {
-                    auto q = buyOrders[price];
-                    while (!q.empty()) {
-                        auto o = q.front();
-                        if (o.id == id) {
-                            filled = o.filled_quantity;
-                            total = o.quantity;
-                            break;
-                        }
-                        q.pop();
-                    }
-                } else if (sellOrders.count(price)) {
-                    auto q = sellOrders[price];
-                    while (!q.empty()) {
-                        auto o = q.front();
-                        if (o.id == id) {
-                            filled = o.filled_quantity;
-                            total = o.quantity;
-                            break;
-                        }
-                        q.pop();
-                    }
+                auto resting = restingOrders.find(id);
+                if (resting != restingOrders.end()) {
+                    filled = resting->second->filled_quantity;
+                    total = resting->second->quantity;
                 }
                 
                 statusOut << id << "," << statusToStr(status) << "," 
@@ -365,29 +238,21 @@ private:
         buyOut << "OrderID,Price,Quantity,FilledQuantity,Timestamp\n";
         sellOut << "OrderID,Price,Quantity,FilledQuantity,Timestamp\n";
 
-        for (auto it = buyOrders.begin(); it != buyOrders.end();it++) {
-            auto price = it->first;
-            auto q = it->second;
-            auto tempQ = q;
-            while (!tempQ.empty()) {
-                const auto& o = tempQ.front();
-                buyOut << o.id << "," << o.price << "," << o.quantity << ","
-                       << o.filled_quantity << "," << o.timestamp << "\n";
-                tempQ.pop();
+        buyOrders.forEachLevel([&buyOut](int, const PriceLevel& level) {
+            for (const Order* o = level.head; o; o = o->next) {
+                buyOut << o->id << "," << o->price << "," << o->quantity << ","
+                       << o->filled_quantity << "," << OrderPool::info(o).timestamp << "\n";
             }
-        }
+            return true;
+        });
 
-        for (auto it = sellOrders.begin(); it != sellOrders.end();it++) {
-            auto price = it->first;
-            auto q = it->second;
-            auto tempQ = q;
-            while (!tempQ.empty()) {
-                const auto& o = tempQ.front();
-                sellOut << o.id << "," << o.price << "," << o.quantity << ","
-                        << o.filled_quantity << "," << o.timestamp << "\n";
-                tempQ.pop();
+        sellOrders.forEachLevel([&sellOut](int, const PriceLevel& level) {
+            for (const Order* o = level.head; o; o = o->next) {
+                sellOut << o->id << "," << o->price << "," << o->quantity << ","
+                        << o->filled_quantity << "," << OrderPool::info(o).timestamp << "\n";
             }
-        }
+            return true;
+        });
     }
 
     void loadOrders(const string& filename, OrderType type) {
@@ -405,18 +270,21 @@ private:
                 stringstream ss(line);
                 string token;
                 Order o;
+                Timestamp timestamp;
                 
-                getline(ss, token, ','); o.id = stoi(token);
+                getline(ss, token, ','); o.id = stoll(token);
                 getline(ss, token, ','); o.price = stoi(token);
                 getline(ss, token, ','); o.quantity = stoi(token);
                 getline(ss, token, ','); o.filled_quantity = stoi(token);
-                getline(ss, token, ','); o.timestamp = stol(token);
+                getline(ss, token, ','); timestamp = stoll(token);
                 o.type = type;
                 
+                Order* resting = orderPool.acquire(o, timestamp);
+                restingOrders.emplace(o.id, resting);
                 if (type == OrderType::BUY) {
-                    buyOrders[o.price].push(o);
+                    buyOrders.push_back(resting);
                 } else {
-                    sellOrders[o.price].push(o);
+                    sellOrders.push_back(resting);
                 }
                 
                 idToPriceAndType[o.id] = {o.price, type};
@@ -424,12 +292,9 @@ private:
                     (o.filled_quantity > 0 ? OrderStatus::PARTIAL : OrderStatus::OPEN);
                 
                 orderId = max(orderId, o.id);
-                time = max(time, o.timestamp);
+                time = max(time, timestamp);
                 
-             
-                idToOrderQueue[o.id] = type == OrderType::BUY ? 
-                    &buyOrders[o.price] : &sellOrders[o.price];
-                    
+
             } catch (const exception& e) {
                 logEvent("Error", "Failed to parse line in " + filename + ": " + line);
                 continue;
@@ -445,8 +310,8 @@ public:
         cout << "\nTop of Order Book:\n";
         
         if (!buyOrders.empty()) {
-            auto price = buyOrders.begin()->first;
-            auto q = buyOrders.begin()->second;
+            auto price = buyOrders.bestPrice();
+            const auto& q = buyOrders.bestLevel();
             if (!q.empty()) {
                 cout << "Top Buy: " << q.front().remaining() 
                      << " @ " << price << endl;
@@ -454,8 +319,8 @@ public:
         }
         
         if (!sellOrders.empty()) {
-            auto price = sellOrders.begin()->first;
-            auto q = sellOrders.begin()->second;
+            auto price = sellOrders.bestPrice();
+            const auto& q = sellOrders.bestLevel();
             if (!q.empty()) {
                 cout << "Top Sell: " << q.front().remaining() 
                      << " @ " << price << endl;
@@ -501,7 +366,7 @@ int main() {
                 }
             } else if (cmd == "cancel") {
                 try {
-                    int id;
+                    OrderId id;
                     cout << "Enter Order ID to cancel: ";
                     cin >> id;
                     ob.cancelOrder(id);
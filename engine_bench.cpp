@@ -0,0 +1,385 @@
+// Micro and macro benchmarks for the matching path, with machine-readable output.
+//
+// Usage: engine_bench [--json FILE] [--repeat N] [--filter TEXT]
+//   match/*  drive MatchingEngine::matchBuyOrder/matchSellOrder directly against
+//            prepared book sides: a deep single level, a wide book of one-order
+//            levels (std::map and ladder) and full-book sweeps.
+//   book/*   drive OrderBook::placeOrder/cancelOrder: passive adds, cancel-heavy
+//            requoting, aggressive sweeps and a mixed crossing flow. Each runs
+//            with persistence and logging stubbed out (/mem) and enabled (/disk).
+// Every scenario runs --repeat times (default 5) and reports the median and the
+// fastest ns/op; bench_compare.py checks the fastest against the stored baseline. Books with persistence
+// enabled live under engine_bench_data/, which is removed at exit.
+#include "OrderBook.h"
+#include "OrderPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Swallows console output from the book (missing-file warnings on a fresh data directory).
+struct NullBuffer : std::streambuf {
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+// One measured repetition: how many operations ran and how long they took in total.
+struct Sample {
+    uint64_t ops = 0;
+    uint64_t nanos = 0;
+};
+
+struct Result {
+    std::string name;
+    uint64_t ops = 0;       // operations per repetition
+    double nsPerOp = 0;     // median over the repetitions
+    double minNsPerOp = 0;
+};
+
+uint64_t elapsedNanos(Clock::time_point start) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+}
+
+// xorshift64, so every run sees the same flow.
+struct Rng {
+    uint64_t state = 0x2545F4914F6CDD1Dull;
+    uint64_t next() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+};
+
+Order makeOrder(OrderId id, OrderType type, int price, int quantity) {
+    return Order{id, type, TimeInForce::GTC, OrderKind::LIMIT, price, quantity, 0};
+}
+
+// ---- MatchingEngine in isolation ------------------------------------------
+
+// Collects the trades of one match and hands each fully filled resting order
+// back to its pool, as OrderBook does.
+struct TradeCollector {
+    std::vector<Trade>& trades;
+    OrderPool& pool;
+
+    void operator()(const Trade& trade, Order& resting) {
+        trades.push_back(trade);
+        if (resting.is_filled()) pool.release(&resting);
+    }
+};
+
+// One price level holding many orders; each incoming buy fills exactly one of them.
+Sample matchDeepLevel() {
+    constexpr int kOrders = 20000;
+    OrderPool pool(kOrders);
+    SellBook sells;
+    for (int i = 0; i < kOrders; ++i) sells.push_back(pool.acquire(makeOrder(i + 1, OrderType::SELL, 1000, 10), 0));
+
+    MatchingEngine engine;
+    std::vector<Trade> trades;
+    trades.reserve(256);
+    int64_t tradeId = 1;
+    Order buy = makeOrder(0, OrderType::BUY, 1000, 10);
+
+    auto start = Clock::now();
+    for (int i = 0; i < kOrders; ++i) {
+        buy.filled_quantity = 0;
+        trades.clear();
+        engine.matchBuyOrder(buy, sells, tradeId, 0, TradeCollector{trades, pool});
+    }
+    return {kOrders, elapsedNanos(start)};
+}
+
+// Many levels with one order each; each incoming sell takes out the best level.
+Sample matchWideBook(bool ladder) {
+    constexpr int kLevels = 20000;
+    OrderPool pool(kLevels);
+    BuyBook buys;
+    if (ladder) buys.useLadder(1, 1000 + kLevels);
+    buys.reserveLevels(kLevels);
+    for (int i = 0; i < kLevels; ++i) buys.push_back(pool.acquire(makeOrder(i + 1, OrderType::BUY, 1000 + i, 10), 0));
+
+    MatchingEngine engine;
+    std::vector<Trade> trades;
+    trades.reserve(256);
+    int64_t tradeId = 1;
+    Order sell = makeOrder(0, OrderType::SELL, 1, 10);
+
+    auto start = Clock::now();
+    for (int i = 0; i < kLevels; ++i) {
+        sell.filled_quantity = 0;
+        trades.clear();
+        engine.matchSellOrder(sell, buys, tradeId, 0, TradeCollector{trades, pool});
+    }
+    return {kLevels, elapsedNanos(start)};
+}
+
+// 100 levels of 10 orders per side; one buy sweeps every sell, then one sell
+// sweeps every buy. The books are rebuilt between sweeps outside the timing.
+Sample matchSweep() {
+    constexpr int kLevels = 100, kPerLevel = 10, kRounds = 200;
+    std::vector<Trade> trades;
+    trades.reserve(kLevels * kPerLevel);
+    MatchingEngine engine;
+    int64_t tradeId = 1;
+    Sample sample;
+
+    for (int round = 0; round < kRounds; ++round) {
+        OrderPool pool(2 * kLevels * kPerLevel);
+        SellBook sells;
+        BuyBook buys;
+        for (int l = 0; l < kLevels; ++l) {
+            for (int k = 0; k < kPerLevel; ++k) {
+                sells.push_back(pool.acquire(makeOrder(0, OrderType::SELL, 1001 + l, 5), 0));
+                buys.push_back(pool.acquire(makeOrder(0, OrderType::BUY, 1000 - l, 5), 0));
+            }
+        }
+
+        Order buy = makeOrder(0, OrderType::BUY, 1000 + kLevels, kLevels * kPerLevel * 5);
+        Order sell = makeOrder(0, OrderType::SELL, 1000 - kLevels, kLevels * kPerLevel * 5);
+        auto start = Clock::now();
+        trades.clear();
+        engine.matchBuyOrder(buy, sells, tradeId, 0, TradeCollector{trades, pool});
+        trades.clear();
+        engine.matchSellOrder(sell, buys, tradeId, 0, TradeCollector{trades, pool});
+        sample.nanos += elapsedNanos(start);
+        sample.ops += 2;
+    }
+    return sample;
+}
+
+// ---- OrderBook --------------------------------------------------------------
+
+// An OrderBook either in memory with its log sent to /dev/null, or with the
+// journal, trade log and log files written under its own directory.
+struct BenchBook {
+    BenchBook(const std::string& name, bool persist) {
+        OrderBookConfig config;
+        config.quiet = true;
+        config.persist = persist;
+        LoggerOptions loggerOptions;
+        if (persist) {
+            dir = "engine_bench_data/" + name;
+            std::filesystem::remove_all(dir);
+            std::filesystem::create_directories(dir);
+            config.dataDir = dir;
+            loggerOptions.binaryLogFile = dir + "/events.bin";
+            logger = std::make_shared<Logger>(dir + "/events.log", loggerOptions);
+        } else {
+            loggerOptions.binaryLogFile = "/dev/null";
+            logger = std::make_shared<Logger>("/dev/null", loggerOptions);
+        }
+        book = std::make_unique<OrderBook>(logger, config);
+    }
+
+    ~BenchBook() {
+        book.reset();
+        logger.reset();
+        if (!dir.empty()) std::filesystem::remove_all(dir);
+    }
+
+    std::string dir;
+    std::shared_ptr<Logger> logger;
+    std::unique_ptr<OrderBook> book;
+};
+
+// Orders that never cross: buys below 1000, sells above it.
+Sample bookPassiveAdd(bool persist) {
+    constexpr int kOrders = 100000;
+    BenchBook b("passive_add", persist);
+    Rng rng;
+    auto start = Clock::now();
+    for (int i = 0; i < kOrders; ++i) {
+        uint64_t r = rng.next();
+        int offset = 1 + static_cast<int>((r >> 8) % 100);
+        if (r & 1) {
+            b.book->placeOrder(OrderType::BUY, 1000 - offset, 1 + static_cast<int>((r >> 24) % 100));
+        } else {
+            b.book->placeOrder(OrderType::SELL, 1000 + offset, 1 + static_cast<int>((r >> 24) % 100));
+        }
+    }
+    return {kOrders, elapsedNanos(start)};
+}
+
+// A market maker requoting: with 10000 orders resting, repeatedly cancel a
+// random live order and place a passive replacement. Each cancel and each
+// place counts as one operation.
+Sample bookCancelHeavy(bool persist) {
+    constexpr int kResting = 10000, kRequotes = 50000;
+    BenchBook b("cancel_heavy", persist);
+    Rng rng;
+    auto quote = [&](uint64_t r) {
+        int offset = 1 + static_cast<int>((r >> 8) % 100);
+        return (r & 1) ? b.book->placeOrder(OrderType::BUY, 1000 - offset, 10)
+                       : b.book->placeOrder(OrderType::SELL, 1000 + offset, 10);
+    };
+    std::vector<OrderId> live;
+    live.reserve(kResting);
+    for (int i = 0; i < kResting; ++i) live.push_back(quote(rng.next()));
+
+    auto start = Clock::now();
+    for (int i = 0; i < kRequotes; ++i) {
+        uint64_t r = rng.next();
+        std::size_t slot = static_cast<std::size_t>((r >> 32) % live.size());
+        b.book->cancelOrder(live[slot]);
+        live[slot] = quote(r);
+    }
+    return {2 * kRequotes, elapsedNanos(start)};
+}
+
+// 50 levels of 20 orders per side; each timed order crosses 10 levels. The
+// swept levels are refilled outside the timing.
+Sample bookAggressiveSweep(bool persist) {
+    constexpr int kLevels = 50, kPerLevel = 20, kSweepLevels = 10, kSweeps = 2000;
+    BenchBook b("aggressive_sweep", persist);
+    auto refill = [&](OrderType type, int firstPrice, int step, int levels) {
+        for (int l = 0; l < levels; ++l) {
+            for (int k = 0; k < kPerLevel; ++k) b.book->placeOrder(type, firstPrice + l * step, 10);
+        }
+    };
+    refill(OrderType::SELL, 1001, 1, kLevels);
+    refill(OrderType::BUY, 1000, -1, kLevels);
+
+    Sample sample;
+    for (int i = 0; i < kSweeps; ++i) {
+        bool buy = (i & 1) == 0;
+        auto start = Clock::now();
+        if (buy) {
+            b.book->placeOrder(OrderType::BUY, 1000 + kSweepLevels, kSweepLevels * kPerLevel * 10);
+        } else {
+            b.book->placeOrder(OrderType::SELL, 1001 - kSweepLevels, kSweepLevels * kPerLevel * 10);
+        }
+        sample.nanos += elapsedNanos(start);
+        ++sample.ops;
+        if (buy) {
+            refill(OrderType::SELL, 1001, 1, kSweepLevels);
+        } else {
+            refill(OrderType::BUY, 1000, -1, kSweepLevels);
+        }
+    }
+    return sample;
+}
+
+// Random buys and sells straddling 1000, so roughly half of them trade.
+Sample bookMixed(bool persist) {
+    constexpr int kOrders = 100000;
+    BenchBook b("mixed", persist);
+    Rng rng;
+    auto start = Clock::now();
+    for (int i = 0; i < kOrders; ++i) {
+        uint64_t r = rng.next();
+        b.book->placeOrder((r & 1) ? OrderType::BUY : OrderType::SELL, 990 + static_cast<int>((r >> 8) % 21),
+                           1 + static_cast<int>((r >> 24) % 100));
+    }
+    return {kOrders, elapsedNanos(start)};
+}
+
+struct Scenario {
+    std::string name;
+    std::function<Sample()> run;
+};
+
+std::vector<Scenario> scenarios() {
+    std::vector<Scenario> list = {
+        {"match/deep_level", matchDeepLevel},
+        {"match/wide_book/map", [] { return matchWideBook(false); }},
+        {"match/wide_book/ladder", [] { return matchWideBook(true); }},
+        {"match/sweep", matchSweep},
+    };
+    const std::pair<const char*, Sample (*)(bool)> bookScenarios[] = {
+        {"book/passive_add", bookPassiveAdd},
+        {"book/cancel_heavy", bookCancelHeavy},
+        {"book/aggressive_sweep", bookAggressiveSweep},
+        {"book/mixed", bookMixed},
+    };
+    for (const auto& [name, fn] : bookScenarios) {
+        list.push_back({std::string(name) + "/mem", [fn = fn] { return fn(false); }});
+        list.push_back({std::string(name) + "/disk", [fn = fn] { return fn(true); }});
+    }
+    return list;
+}
+
+Result measure(const Scenario& scenario, int repeat) {
+    std::vector<double> perOp;
+    Result result;
+    result.name = scenario.name;
+    for (int i = 0; i < repeat; ++i) {
+        Sample s = scenario.run();
+        result.ops = s.ops;
+        perOp.push_back(s.ops ? static_cast<double>(s.nanos) / static_cast<double>(s.ops) : 0);
+    }
+    std::sort(perOp.begin(), perOp.end());
+    result.nsPerOp = perOp[perOp.size() / 2];
+    result.minNsPerOp = perOp.front();
+    return result;
+}
+
+void writeJson(std::ostream& out, const std::vector<Result>& results, int repeat) {
+    out << "{\n  \"repeat\": " << repeat << ",\n  \"benchmarks\": [\n";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        double opsPerSec = r.nsPerOp > 0 ? 1e9 / r.nsPerOp : 0;
+        out << "    {\"name\": \"" << r.name << "\", \"ops\": " << r.ops << ", \"ns_per_op\": " << r.nsPerOp
+            << ", \"min_ns_per_op\": " << r.minNsPerOp << ", \"ops_per_sec\": " << static_cast<uint64_t>(opsPerSec)
+            << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string jsonFile;
+    std::string filter;
+    int repeat = 5;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--json" && i + 1 < argc) {
+            jsonFile = argv[++i];
+        } else if (arg == "--repeat" && i + 1 < argc) {
+            repeat = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--filter" && i + 1 < argc) {
+            filter = argv[++i];
+        } else {
+            std::cerr << "Usage: engine_bench [--json FILE] [--repeat N] [--filter TEXT]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<Result> results;
+    for (const Scenario& scenario : scenarios()) {
+        if (!filter.empty() && scenario.name.find(filter) == std::string::npos) continue;
+        NullBuffer discard;
+        std::streambuf* errors = std::cerr.rdbuf(&discard);
+        Result r = measure(scenario, repeat);
+        std::cerr.rdbuf(errors);
+        results.push_back(r);
+        std::cout << r.name << ": " << r.nsPerOp << " ns/op (min " << r.minNsPerOp << "), "
+                  << static_cast<uint64_t>(r.nsPerOp > 0 ? 1e9 / r.nsPerOp : 0) << " ops/sec" << std::endl;
+    }
+    std::filesystem::remove_all("engine_bench_data");
+
+    if (!jsonFile.empty()) {
+        std::ofstream out(jsonFile);
+        if (!out) {
+            std::cerr << "Cannot write " << jsonFile << std::endl;
+            return 1;
+        }
+        writeJson(out, results, repeat);
+    }
+    return 0;
+}
@@ -0,0 +1,292 @@
+// Measures what the 32-byte hot Order buys while sweeping deep price levels,
+// against the 64-byte order it replaced (every field and link in one record).
+//
+// Usage: layout_bench [orders] [orders per level] [rounds]
+//   Builds a book of ORDERS (default 1000000) resting orders, PER LEVEL (default
+//   1000) to a level, then takes every level out front to back the way the
+//   matching loop does: read the head, fill it, pop it, return it to its pool.
+//   Orders are allocated either level by level (sequential) or in a random
+//   arrival order across levels (shuffled), which scatters each level's queue
+//   over the whole pool. Only the sweeps are timed. Cache misses come from
+//   perf_event_open and read n/a where the kernel does not allow it. Build with
+//   optimisation (make CXXFLAGS="-std=c++17 -O2 -pthread") for meaningful figures.
+#include "OrderPool.h"
+#include "PriceLevel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+// The order layout before the hot/cold split, kept as the baseline.
+struct LegacyOrder {
+    int id;
+    OrderType type;
+    int price;
+    int quantity;
+    int filled_quantity = 0;
+    TimeInForce timeInForce = TimeInForce::GTC;
+    OrderKind kind = OrderKind::LIMIT;
+    uint16_t owner = 0;
+    time_t timestamp = 0;
+    LegacyOrder* prev = nullptr;
+    LegacyOrder* next = nullptr;
+    LegacyOrder* ownerPrev = nullptr;
+    LegacyOrder* ownerNext = nullptr;
+
+    int remaining() const { return quantity - filled_quantity; }
+};
+
+// The level that went with it: popping the head also cleared the next order's prev.
+struct LegacyLevel {
+    LegacyOrder* head = nullptr;
+    LegacyOrder* tail = nullptr;
+    int64_t quantity = 0;
+    uint32_t count = 0;
+
+    bool empty() const { return head == nullptr; }
+
+    void push_back(LegacyOrder* order) {
+        order->prev = tail;
+        order->next = nullptr;
+        if (tail) {
+            tail->next = order;
+        } else {
+            head = order;
+        }
+        tail = order;
+        quantity += order->remaining();
+        ++count;
+    }
+
+    void pop_front() {
+        LegacyOrder* order = head;
+        quantity -= order->remaining();
+        --count;
+        head = order->next;
+        if (head) {
+            head->prev = nullptr;
+        } else {
+            tail = nullptr;
+        }
+        order->next = nullptr;
+    }
+};
+
+// A contiguous slab with a free list through next, as OrderPool was.
+struct LegacyPool {
+    explicit LegacyPool(std::size_t capacity) : slab(capacity) {
+        for (std::size_t i = capacity; i-- > 0;) {
+            slab[i].next = freeList;
+            freeList = &slab[i];
+        }
+    }
+
+    LegacyOrder* acquire(const LegacyOrder& init) {
+        LegacyOrder* node = freeList;
+        freeList = node->next;
+        *node = init;
+        node->prev = node->next = node->ownerPrev = node->ownerNext = nullptr;
+        return node;
+    }
+
+    void release(LegacyOrder* node) {
+        node->next = freeList;
+        freeList = node;
+    }
+
+    std::vector<LegacyOrder> slab;
+    LegacyOrder* freeList = nullptr;
+};
+
+// One hardware counter for the calling thread, user space only.
+class PerfCounter {
+public:
+    PerfCounter(uint32_t type, uint64_t config) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    ~PerfCounter() {
+        if (fd >= 0) ::close(fd);
+    }
+
+    PerfCounter(const PerfCounter&) = delete;
+    PerfCounter& operator=(const PerfCounter&) = delete;
+
+    bool available() const { return fd >= 0; }
+
+    void start() {
+        if (fd < 0) return;
+        ::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+
+    // Stops counting and returns the count since start().
+    uint64_t stop() {
+        if (fd < 0) return 0;
+        ::ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        uint64_t value = 0;
+        if (::read(fd, &value, sizeof(value)) != sizeof(value)) return 0;
+        return value;
+    }
+
+private:
+    int fd = -1;
+};
+
+constexpr uint64_t kL1dReadMiss = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+struct Totals {
+    uint64_t orders = 0;
+    uint64_t nanos = 0;
+    uint64_t l1dMisses = 0;
+    uint64_t llcMisses = 0;
+    int64_t checksum = 0; // keeps the sweep from being optimised away
+};
+
+// Drains every level front to back, as a sweep through the whole book would.
+template <typename Level, typename Pool>
+void sweep(std::vector<Level>& levels, Pool& pool, Totals& totals, PerfCounter& l1d, PerfCounter& llc) {
+    l1d.start();
+    llc.start();
+    auto start = std::chrono::steady_clock::now();
+    int64_t notional = 0;
+    uint64_t orders = 0;
+    for (Level& level : levels) {
+        while (!level.empty()) {
+            auto* order = level.head;
+            int fill = order->remaining();
+            order->filled_quantity += fill;
+            notional += static_cast<int64_t>(fill) * order->price;
+            level.pop_front();
+            pool.release(order);
+            ++orders;
+        }
+    }
+    totals.nanos += static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    totals.l1dMisses += l1d.stop();
+    totals.llcMisses += llc.stop();
+    totals.orders += orders;
+    totals.checksum += notional;
+}
+
+// levelOf[i] is the level the i-th order to arrive joins.
+std::vector<uint32_t> arrivals(std::size_t orders, std::size_t levels, bool shuffled) {
+    std::vector<uint32_t> levelOf(orders);
+    for (std::size_t i = 0; i < orders; ++i) levelOf[i] = static_cast<uint32_t>(i / (orders / levels));
+    if (shuffled) {
+        uint64_t state = 0x2545F4914F6CDD1Dull;
+        for (std::size_t i = orders; i > 1; --i) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            std::swap(levelOf[i - 1], levelOf[state % i]);
+        }
+    }
+    return levelOf;
+}
+
+Totals runLegacy(const std::vector<uint32_t>& levelOf, std::size_t levels, int rounds, PerfCounter& l1d,
+                 PerfCounter& llc) {
+    Totals totals;
+    for (int round = 0; round < rounds; ++round) {
+        LegacyPool pool(levelOf.size());
+        std::vector<LegacyLevel> book(levels);
+        for (std::size_t i = 0; i < levelOf.size(); ++i) {
+            LegacyOrder o;
+            o.id = static_cast<int>(i + 1);
+            o.type = OrderType::SELL;
+            o.price = 1000 + static_cast<int>(levelOf[i]);
+            o.quantity = 1 + static_cast<int>(i % 100);
+            book[levelOf[i]].push_back(pool.acquire(o));
+        }
+        sweep(book, pool, totals, l1d, llc);
+    }
+    return totals;
+}
+
+Totals runSplit(const std::vector<uint32_t>& levelOf, std::size_t levels, int rounds, PerfCounter& l1d,
+                PerfCounter& llc) {
+    Totals totals;
+    for (int round = 0; round < rounds; ++round) {
+        OrderPool pool(levelOf.size());
+        std::vector<PriceLevel> book(levels);
+        for (std::size_t i = 0; i < levelOf.size(); ++i) {
+            Order o{static_cast<OrderId>(i + 1), OrderType::SELL, TimeInForce::GTC, OrderKind::LIMIT,
+                    1000 + static_cast<int>(levelOf[i]), 1 + static_cast<int>(i % 100), 0};
+            book[levelOf[i]].push_back(pool.acquire(o, 0));
+        }
+        sweep(book, pool, totals, l1d, llc);
+    }
+    return totals;
+}
+
+void report(const char* name, const Totals& t, bool counters) {
+    double orders = static_cast<double>(t.orders);
+    std::cout << std::left << std::setw(30) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(8) << static_cast<double>(t.nanos) / orders << " ns/order";
+    if (counters) {
+        std::cout << std::setw(8) << static_cast<double>(t.l1dMisses) / orders << " L1d misses/order"
+                  << std::setw(8) << static_cast<double>(t.llcMisses) / orders << " LLC misses/order";
+    } else {
+        std::cout << "      n/a L1d misses/order      n/a LLC misses/order";
+    }
+    std::cout << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::size_t orders = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    std::size_t perLevel = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1000;
+    int rounds = argc > 3 ? std::atoi(argv[3]) : 5;
+    if (orders == 0 || perLevel == 0 || perLevel > orders || rounds <= 0) {
+        std::cerr << "Usage: layout_bench [orders] [orders per level] [rounds]" << std::endl;
+        return 1;
+    }
+    std::size_t levels = orders / perLevel;
+    orders = levels * perLevel;
+
+    PerfCounter l1d(PERF_TYPE_HW_CACHE, kL1dReadMiss);
+    PerfCounter llc(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    bool counters = l1d.available() && llc.available();
+
+    std::cout << "sizeof(Order) " << sizeof(Order) << " + sizeof(OrderInfo) " << sizeof(OrderInfo)
+              << " (was " << sizeof(LegacyOrder) << "); " << orders << " orders in " << levels << " levels, "
+              << rounds << " rounds" << std::endl;
+    for (bool shuffled : {false, true}) {
+        std::vector<uint32_t> levelOf = arrivals(orders, levels, shuffled);
+        Totals legacy = runLegacy(levelOf, levels, rounds, l1d, llc);
+        Totals split = runSplit(levelOf, levels, rounds, l1d, llc);
+        if (legacy.checksum != split.checksum) {
+            std::cerr << "The two layouts swept different books" << std::endl;
+            return 1;
+        }
+        std::string prefix = shuffled ? "shuffled, " : "sequential, ";
+        report((prefix + "64-byte order").c_str(), legacy, counters);
+        report((prefix + "32-byte hot half").c_str(), split, counters);
+    }
+    return 0;
+}
@@ -0,0 +1,57 @@
+// Turns the structured events in events.bin back into human-readable log lines,
+// in the same format as events.log but with nanoseconds after the second.
+//
+// Usage: log_decoder [events.bin] [output.log]   (output defaults to stdout)
+#include "LogEvents.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+
+int main(int argc, char* argv[]) {
+    const char* inputFile = argc > 1 ? argv[1] : "events.bin";
+    std::ifstream in(inputFile, std::ios::binary);
+    if (!in.is_open()) {
+        std::cerr << "Failed to open " << inputFile << std::endl;
+        return 1;
+    }
+
+    char magic[sizeof(kBinaryLogMagic)];
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, kBinaryLogMagic, sizeof(magic)) != 0) {
+        std::cerr << inputFile << " is not a binary event log" << std::endl;
+        return 1;
+    }
+
+    std::ofstream file;
+    if (argc > 2) {
+        file.open(argv[2], std::ios::app);
+        if (!file.is_open()) {
+            std::cerr << "Failed to open " << argv[2] << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& out = argc > 2 ? file : std::cout;
+
+    BinaryLogRecord record;
+    std::size_t count = 0;
+    char stamp[48];
+    while (in.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+        time_t seconds = static_cast<time_t>(record.timestamp / 1000000000);
+        std::size_t length = std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", std::localtime(&seconds));
+        std::snprintf(stamp + length, sizeof(stamp) - length, ".%09lld",
+                      static_cast<long long>(record.timestamp % 1000000000));
+        const char* category = record.event < static_cast<uint16_t>(LogEvent::COUNT)
+                                   ? kLogEvents[record.event].category : "Unknown";
+        out << stamp << " [" << category << "] " << formatLogEvent(record) << "\n";
+        ++count;
+    }
+    if (in.gcount() != 0) {
+        std::cerr << "Warning: ignoring a truncated record at the end of " << inputFile << std::endl;
+    }
+
+    std::cerr << "Decoded " << count << " events." << std::endl;
+    return 0;
+}
@@ -5,20 +5,111 @@
 #include <fstream>
 #include <chrono>
 #include <iomanip>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "LogEvents.h"
+
+// What an asynchronous Logger does when its ring buffer is full.
+enum class LogOverflowPolicy {
+    BLOCK, // wait for the writer thread to make room
+    DROP,  // discard the message and count it
+    SPILL  // park the message in an unbounded overflow list
+};
+
+struct LoggerOptions {
+    // Hand messages to a background writer thread instead of writing them inline.
+    bool async = false;
+    std::size_t queueCapacity = 8192; // rounded up to a power of two
+    LogOverflowPolicy overflow = LogOverflowPolicy::BLOCK;
+
+    // Structured events (Logger::event) are appended here in binary and turned
+    // back into text by log_decoder. When empty they are formatted into the
+    // text log as they happen instead.
+    std::string binaryLogFile = "events.bin";
+};
 
 // A simple file logger class.
 class Logger {
 public:
     // Constructor opens the log file.
-    Logger(const std::string& log_file);
-    // Destructor closes the log file.
+    Logger(const std::string& log_file, const LoggerOptions& options = LoggerOptions());
+    // Destructor drains any queued messages and closes the log file.
     ~Logger();
 
     // Logs a message with a given category (e.g., "System", "Error").
+    // In async mode this only copies the message into the ring buffer, and
+    // must be called from one thread at a time.
     void log(const std::string& category, const std::string& message);
 
+    // Records a structured event: a fixed event id plus up to four integer
+    // arguments, stored without formatting and stamped with the event time.
+    // Events whose level is below OME_LOG_LEVEL compile to nothing at the call site.
+    template <LogEvent E, typename... Args>
+    void event(Args... args) {
+        if constexpr (logEventLevel(E) >= kCompiledLogLevel) {
+            static_assert(sizeof...(Args) <= 4, "Structured log events take at most four arguments");
+            BinaryLogRecord record{eventTime, static_cast<uint16_t>(E),
+                                   static_cast<uint16_t>(sizeof...(Args)), 0, {static_cast<int64_t>(args)...}};
+            logEvent(record);
+        }
+    }
+
+    // Nanoseconds since the epoch given to the structured events recorded from
+    // now on. The book sets it once per command, so the logger reads no clock
+    // of its own for events.
+    void setEventTime(int64_t nanos) { eventTime = nanos; }
+
+    // Messages discarded under LogOverflowPolicy::DROP.
+    std::size_t droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
 private:
-    std::ofstream eventLog; // The file stream for logging.
+    // A fixed-size slot in the ring buffer. Longer messages are truncated.
+    struct Record {
+        time_t timestamp;
+        uint32_t length;
+        bool binary; // message holds a BinaryLogRecord
+        char category[19];
+        char message[224];
+    };
+
+    std::ofstream eventLog;  // The file stream for logging.
+    std::ofstream binaryLog; // Structured events, see LoggerOptions::binaryLogFile.
+    LoggerOptions options;
+    int64_t eventTime = 0;
+
+    // Single-producer ring buffer, drained by the writer thread.
+    std::unique_ptr<Record[]> ring;
+    std::size_t ringMask = 0;
+    alignas(64) std::atomic<std::size_t> head{0}; // next slot the producer fills
+    alignas(64) std::atomic<std::size_t> tail{0}; // next slot the writer reads
+    alignas(64) std::atomic<std::size_t> dropped{0};
+
+    std::mutex spillMutex;
+    std::vector<Record> spill;
+    std::atomic<bool> spilling{false};
+
+    std::thread writer;
+    std::atomic<bool> stopping{false};
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+
+    // Formatted "%Y-%m-%d %H:%M:%S" for the last second written.
+    time_t cachedSecond = -1;
+    char cachedStamp[32] = {};
+
+    void write(time_t timestamp, const char* category, const char* message, std::size_t length);
+    void writeRecord(const Record& record);
+    void logEvent(const BinaryLogRecord& record);
+    void enqueue(const Record& record);
+    void runWriter();
+    bool drainBatch();
 
     // Gets the current system time as a timestamp.
     time_t getCurrentTimestamp() const;
@@ -1,4 +1,6 @@
 #include "OrderBook.h"
+#include "SymbolEngine.h"
+#include "BatchDriver.h"
 #include "Logger.h"
 #include <iostream>
 #include <string>
@@ -9,6 +11,7 @@
 void run_console_ui(OrderBook& ob) {
     std::cout << "Order Matching Engine (Enter 'help' for commands, 'exit' to quit)\n";
     std::string cmd;
+    uint16_t session = 0; // owner of the orders placed from here, for masscancel
 
     while (true) {
         std::cout << "> ";
@@ -28,13 +31,43 @@ void run_console_ui(OrderBook& ob) {
                     throw std::invalid_argument("Invalid input. Please enter numbers.");
                 }
 
-                ob.placeOrder(cmd == "buy" ? OrderType::BUY : OrderType::SELL, price, quantity);
+                ob.placeOrder(cmd == "buy" ? OrderType::BUY : OrderType::SELL, price, quantity, TimeInForce::GTC, session);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << std::endl;
+            }
+        } else if (cmd == "ioc" || cmd == "fok" || cmd == "market") {
+            try {
+                std::string side;
+                int price = 0, quantity;
+                if (cmd == "market") {
+                    std::cout << "Enter side (buy/sell) and quantity: ";
+                    std::cin >> side >> quantity;
+                } else {
+                    std::cout << "Enter side (buy/sell), price and quantity: ";
+                    std::cin >> side >> price >> quantity;
+                }
+
+                if (std::cin.fail()) {
+                    std::cin.clear();
+                    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                    throw std::invalid_argument("Invalid input. Please enter a side and numbers.");
+                }
+                if (side != "buy" && side != "sell") {
+                    throw std::invalid_argument("Invalid side. Please enter buy or sell.");
+                }
+
+                OrderType type = side == "buy" ? OrderType::BUY : OrderType::SELL;
+                if (cmd == "market") {
+                    ob.placeMarketOrder(type, quantity, TimeInForce::IOC, session);
+                } else {
+                    ob.placeOrder(type, price, quantity, cmd == "ioc" ? TimeInForce::IOC : TimeInForce::FOK, session);
+                }
             } catch (const std::exception& e) {
                 std::cerr << "Error: " << e.what() << std::endl;
             }
         } else if (cmd == "cancel") {
             try {
-                int id;
+                OrderId id;
                 std::cout << "Enter Order ID to cancel: ";
                 std::cin >> id;
                  if (std::cin.fail()) {
@@ -47,14 +80,93 @@ void run_console_ui(OrderBook& ob) {
             } catch (const std::exception& e) {
                 std::cerr << "Error: " << e.what() << std::endl;
             }
+        } else if (cmd == "modify") {
+            try {
+                OrderId id;
+                int price, quantity;
+                std::cout << "Enter Order ID, new price and new total quantity: ";
+                std::cin >> id >> price >> quantity;
+                if (std::cin.fail()) {
+                    std::cin.clear();
+                    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                    throw std::invalid_argument("Invalid input. Please enter three numbers.");
+                }
+                ob.modifyOrder(id, price, quantity);
+                std::cout << "Order " << id << " modified.\n";
+            } catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << std::endl;
+            }
+        } else if (cmd == "masscancel") {
+            try {
+                std::string side;
+                int minPrice, maxPrice, owner;
+                std::cout << "Enter side (buy/sell/all), lowest and highest price (0 for no limit) and owner (0 for any): ";
+                std::cin >> side >> minPrice >> maxPrice >> owner;
+                if (std::cin.fail()) {
+                    std::cin.clear();
+                    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                    throw std::invalid_argument("Invalid input. Please enter a side and three numbers.");
+                }
+                if (side != "buy" && side != "sell" && side != "all") {
+                    throw std::invalid_argument("Invalid side. Please enter buy, sell or all.");
+                }
+                if (owner < 0 || owner > std::numeric_limits<uint16_t>::max()) {
+                    throw std::invalid_argument("Invalid owner.");
+                }
+
+                MassCancelFilter filter;
+                if (side != "all") filter.side = side == "buy" ? OrderType::BUY : OrderType::SELL;
+                filter.minPrice = minPrice;
+                if (maxPrice > 0) filter.maxPrice = maxPrice;
+                filter.owner = static_cast<uint16_t>(owner);
+                std::cout << ob.massCancel(filter) << " orders cancelled.\n";
+            } catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << std::endl;
+            }
+        } else if (cmd == "session") {
+            int owner;
+            std::cout << "Enter owner ID for new orders (0 for none): ";
+            std::cin >> owner;
+            if (std::cin.fail() || owner < 0 || owner > std::numeric_limits<uint16_t>::max()) {
+                std::cin.clear();
+                std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                std::cerr << "Error: Invalid owner." << std::endl;
+            } else {
+                session = static_cast<uint16_t>(owner);
+            }
         } else if (cmd == "book") {
             ob.showBook();
+        } else if (cmd == "export") {
+            ob.exportBook();
+            std::cout << "Active orders exported to buy_orders.csv and sell_orders.csv.\n";
+        } else if (cmd == "snapshot") {
+            ob.takeSnapshot();
+            std::cout << "Snapshot written to orders.snapshot.\n";
+        } else if (cmd == "pool") {
+            PoolStats stats = ob.poolStats();
+            std::cout << "Orders: " << stats.ordersInUse << " in use of " << stats.orderCapacity
+                      << " (high water " << stats.orderHighWater << ", slabs added " << stats.orderSlabGrowths << ")\n"
+                      << "Order index: capacity " << stats.indexCapacity << " (grown " << stats.indexGrowths << " times)\n"
+                      << "Levels: " << stats.buyLevels << " buy, " << stats.sellLevels << " sell, "
+                      << stats.spareLevels << " spare (" << stats.levelAllocations << " allocated beyond reserve)\n";
+        } else if (cmd == "stats") {
+            ob.printStats(std::cout);
         } else if (cmd == "help") {
              std::cout << "\nAvailable Commands:\n"
                   << "  buy      - Place a new buy order.\n"
                   << "  sell     - Place a new sell order.\n"
+                  << "  ioc      - Place an immediate-or-cancel order; what does not fill at once is dropped.\n"
+                  << "  fok      - Place a fill-or-kill order; it fills in full or is rejected.\n"
+                  << "  market   - Place a market order that takes liquidity at any price (IOC).\n"
                   << "  cancel   - Cancel an existing order by ID.\n"
+                  << "  modify   - Change an order's price and quantity; a size-down at the same price keeps its place.\n"
+                  << "  masscancel - Cancel every resting order on a side, in a price band and/or of one owner.\n"
+                  << "  session  - Set the owner ID given to the orders placed from now on.\n"
                   << "  book     - Show the top of the order book.\n"
+                  << "  export   - Write the active orders to the CSV books now.\n"
+                  << "  snapshot - Write a binary snapshot and restart the journal.\n"
+                  << "  pool     - Show order and price level pool occupancy.\n"
+                  << "  stats    - Show order/trade/cancel counts and per-stage latency.\n"
                   << "  exit     - Save state and exit the application.\n\n";
         } else {
             std::cout << "Unknown command. Type 'help' for a list of commands.\n";
@@ -62,17 +174,233 @@ void run_console_ui(OrderBook& ob) {
     }
 }
 
+// Console for the multi-symbol engine: every order command names its symbol.
+void run_symbol_console(SymbolEngine& engine) {
+    std::cout << "Order Matching Engine, " << engine.workerCount() << " workers, " << engine.symbolCount()
+              << " symbols (Enter 'help' for commands, 'exit' to quit)\n";
+    std::string cmd;
+
+    while (true) {
+        std::cout << "> ";
+        std::cin >> cmd;
+
+        if (cmd == "exit" || !std::cin) {
+            break;
+        } else if (cmd == "buy" || cmd == "sell") {
+            try {
+                std::string symbol;
+                int price, quantity;
+                std::cout << "Enter symbol, price and quantity: ";
+                std::cin >> symbol >> price >> quantity;
+
+                if (std::cin.fail()) {
+                    std::cin.clear();
+                    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                    throw std::invalid_argument("Invalid input. Please enter a symbol and two numbers.");
+                }
 
-int main() {
+                engine.placeOrder(symbol, cmd == "buy" ? OrderType::BUY : OrderType::SELL, price, quantity);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << std::endl;
+            }
+        } else if (cmd == "cancel") {
+            try {
+                std::string symbol;
+                OrderId id;
+                std::cout << "Enter symbol and Order ID to cancel: ";
+                std::cin >> symbol >> id;
+                if (std::cin.fail()) {
+                    std::cin.clear();
+                    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                    throw std::invalid_argument("Invalid input. Please enter a symbol and a number.");
+                }
+                engine.cancelOrder(symbol, id);
+                engine.sync();
+                std::cout << "Order " << id << " cancellation request processed.\n";
+            } catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << std::endl;
+            }
+        } else if (cmd == "book") {
+            try {
+                std::string symbol;
+                std::cout << "Enter symbol: ";
+                std::cin >> symbol;
+                engine.showBook(symbol);
+                engine.sync();
+            } catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << std::endl;
+            }
+        } else if (cmd == "export") {
+            engine.exportBooks();
+            engine.sync();
+            std::cout << "Active orders exported to each symbol's buy_orders.csv and sell_orders.csv.\n";
+        } else if (cmd == "snapshot") {
+            engine.takeSnapshots();
+            engine.sync();
+            std::cout << "Snapshots written to each symbol's orders.snapshot.\n";
+        } else if (cmd == "help") {
+             std::cout << "\nAvailable Commands:\n"
+                  << "  buy      - Place a new buy order on a symbol.\n"
+                  << "  sell     - Place a new sell order on a symbol.\n"
+                  << "  cancel   - Cancel an existing order by symbol and ID.\n"
+                  << "  book     - Show the top of a symbol's order book.\n"
+                  << "  export   - Write every symbol's active orders to its CSV books now.\n"
+                  << "  snapshot - Write a binary snapshot of every symbol's book.\n"
+                  << "  exit     - Save state and exit the application.\n\n";
+        } else {
+            std::cout << "Unknown command. Type 'help' for a list of commands.\n";
+        }
+    }
+}
+
+
+// Settings taken from the command line.
+struct Options {
+    OrderBookConfig book;
+    LoggerOptions logger;
+
+    // Headless mode (--batch FILE): run the commands in FILE ("-" for stdin) and report throughput.
+    std::string batchFile;
+
+    // Multi-symbol mode (--workers): the book and logger options apply to every symbol.
+    bool multiSymbol = false;
+    SymbolEngineConfig symbols;
+};
+
+// Parses command line options.
+//   --ladder MIN MAX    keep price levels in a tick-indexed ladder for prices in [MIN, MAX]
+//   --order-pool N      preallocate nodes for N live orders
+//   --level-pool N      preallocate map nodes for N price levels per side
+//   --async-log         write events.log from a background thread
+//   --log-queue N       size of the async log ring buffer, in messages
+//   --log-overflow P    what async logging does when the ring is full: block, drop or spill
+//   --trade-durability D  how each batch of trades.csv lines is committed: none, flush or fdatasync
+//                         (fdatasync also syncs every journal commit)
+//   --trade-batch-bytes N write a pending trade batch once it reaches N bytes
+//   --trade-window-us N   group trades from several commands until the oldest is N microseconds old
+//   --snapshot-every N    snapshot the book every N journal records
+//   --import-threads N    parse the CSV books with N threads when starting without a journal
+//   --batch FILE          run the commands in FILE ("-" for stdin) without prompts or per-trade
+//                         output, then print orders/sec, trades/sec and command latency
+//   --workers N           host many symbols, one book each, on N worker threads
+//   --data-dir DIR        where the multi-symbol engine keeps each symbol's files (default symbols)
+//   --no-pin              do not pin the multi-symbol workers to cores
+//   --market-data FILE    publish incremental L2/L3 market data into a memory-mapped ring in FILE
+//   --market-data-capacity N  events the ring holds before the oldest are overwritten
+//   --depth FILE          keep the best bid/offer and top 10 levels per side in a shared file
+//   --fake-clock NS       stamp commands from a deterministic clock starting at NS (nanoseconds
+//                         since the epoch) and advancing 1 microsecond per command
+//   --record FILE         record every inbound command to FILE, with the starting book beside it
+//                         in FILE.snapshot, for the replay tool
+Options parse_options(int argc, char* argv[]) {
+    Options options;
+    OrderBookConfig& config = options.book;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--ladder" && i + 2 < argc) {
+            config.useLadder = true;
+            config.ladderMinPrice = std::stoi(argv[++i]);
+            config.ladderMaxPrice = std::stoi(argv[++i]);
+        } else if (arg == "--order-pool" && i + 1 < argc) {
+            config.orderPoolCapacity = std::stoul(argv[++i]);
+        } else if (arg == "--level-pool" && i + 1 < argc) {
+            config.levelPoolCapacity = std::stoul(argv[++i]);
+        } else if (arg == "--async-log") {
+            options.logger.async = true;
+        } else if (arg == "--log-queue" && i + 1 < argc) {
+            options.logger.queueCapacity = std::stoul(argv[++i]);
+        } else if (arg == "--log-overflow" && i + 1 < argc) {
+            std::string policy = argv[++i];
+            if (policy == "block") {
+                options.logger.overflow = LogOverflowPolicy::BLOCK;
+            } else if (policy == "drop") {
+                options.logger.overflow = LogOverflowPolicy::DROP;
+            } else if (policy == "spill") {
+                options.logger.overflow = LogOverflowPolicy::SPILL;
+            } else {
+                throw std::invalid_argument("Unknown log overflow policy: " + policy);
+            }
+        } else if (arg == "--trade-durability" && i + 1 < argc) {
+            std::string durability = argv[++i];
+            if (durability == "none") {
+                config.tradeCommit.durability = TradeDurability::NONE;
+            } else if (durability == "flush") {
+                config.tradeCommit.durability = TradeDurability::FLUSH;
+            } else if (durability == "fdatasync") {
+                config.tradeCommit.durability = TradeDurability::FDATASYNC;
+            } else {
+                throw std::invalid_argument("Unknown trade durability: " + durability);
+            }
+        } else if (arg == "--snapshot-every" && i + 1 < argc) {
+            config.snapshotInterval = std::stoul(argv[++i]);
+        } else if (arg == "--import-threads" && i + 1 < argc) {
+            config.importThreads = static_cast<unsigned>(std::stoul(argv[++i]));
+        } else if (arg == "--batch" && i + 1 < argc) {
+            options.batchFile = argv[++i];
+            config.quiet = true;
+        } else if (arg == "--workers" && i + 1 < argc) {
+            options.multiSymbol = true;
+            options.symbols.workers = static_cast<unsigned>(std::stoul(argv[++i]));
+        } else if (arg == "--data-dir" && i + 1 < argc) {
+            options.symbols.dataDir = argv[++i];
+        } else if (arg == "--no-pin") {
+            options.symbols.pinWorkers = false;
+        } else if (arg == "--market-data" && i + 1 < argc) {
+            config.marketDataFile = argv[++i];
+        } else if (arg == "--market-data-capacity" && i + 1 < argc) {
+            config.marketDataCapacity = std::stoul(argv[++i]);
+        } else if (arg == "--depth" && i + 1 < argc) {
+            config.depthFile = argv[++i];
+        } else if (arg == "--trade-batch-bytes" && i + 1 < argc) {
+            config.tradeCommit.maxBatchBytes = std::stoul(argv[++i]);
+        } else if (arg == "--fake-clock" && i + 1 < argc) {
+            config.clock = std::make_shared<FakeClock>(std::stoll(argv[++i]), 1000);
+        } else if (arg == "--record" && i + 1 < argc) {
+            config.recordFile = argv[++i];
+        } else if (arg == "--trade-window-us" && i + 1 < argc) {
+            config.tradeCommit.window = std::chrono::microseconds(std::stol(argv[++i]));
+        } else {
+            throw std::invalid_argument("Unknown option: " + arg);
+        }
+    }
+    return options;
+}
+
+
+int main(int argc, char* argv[]) {
     try {
-        // A shared pointer allows multiple objects to share ownership of the logger.
-        auto logger = std::make_shared<Logger>("events.log");
-        
-        // The main application logic is now encapsulated in the OrderBook class.
-        OrderBook ob(logger);
-        
-        // The user interface is cleanly separated from the core logic.
-        run_console_ui(ob);
+        Options options = parse_options(argc, argv);
+
+        if (options.multiSymbol) {
+            if (options.book.clock) {
+                throw std::invalid_argument("--fake-clock drives a single book and cannot be used with --workers");
+            }
+            if (!options.book.recordFile.empty()) {
+                throw std::invalid_argument("--record covers a single book and cannot be used with --workers");
+            }
+            // One book per symbol, each owned by one of the worker threads.
+            options.symbols.book = options.book;
+            options.symbols.logger = options.logger;
+            SymbolEngine engine(options.symbols);
+            run_symbol_console(engine);
+        } else {
+            // A shared pointer allows multiple objects to share ownership of the logger.
+            auto logger = std::make_shared<Logger>("events.log", options.logger);
+
+            // The main application logic is now encapsulated in the OrderBook class.
+            OrderBook ob(logger, options.book);
+
+            if (!options.batchFile.empty()) {
+                BatchDriver driver(ob);
+                if (!driver.run(options.batchFile)) {
+                    throw std::runtime_error("Could not open batch file: " + options.batchFile);
+                }
+                driver.printReport(std::cout);
+            } else {
+                // The user interface is cleanly separated from the core logic.
+                run_console_ui(ob);
+            }
+        }
 
     } catch (const std::exception& e) {
         std::cerr << "A fatal error occurred: " << e.what() << std::endl;
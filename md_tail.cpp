@@ -0,0 +1,107 @@
+// Follows a market data feed (see MarketData.h) and prints one line per event.
+//
+// Usage: md_tail FEED [--rewind] [--snapshot] [--no-follow]
+//   --rewind     start from the oldest event still in the ring instead of the newest
+//   --snapshot   ask the engine for a snapshot of the book first
+//   --no-follow  exit once every published event has been printed
+// After a gap it asks for a snapshot by itself, since the book it would have
+// built from the missed deltas can no longer be trusted.
+#include "MarketData.h"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+
+namespace {
+
+const char* typeName(uint16_t type) {
+    switch (static_cast<MarketDataEventType>(type)) {
+        case MarketDataEventType::BOOK_RESET: return "RESET";
+        case MarketDataEventType::SNAPSHOT_END: return "SNAPSHOT_END";
+        case MarketDataEventType::ADD: return "ADD";
+        case MarketDataEventType::EXECUTE: return "EXECUTE";
+        case MarketDataEventType::CANCEL: return "CANCEL";
+        case MarketDataEventType::LEVEL: return "LEVEL";
+        case MarketDataEventType::MODIFY: return "MODIFY";
+        default: return "UNKNOWN";
+    }
+}
+
+void print(const MarketDataEvent& e) {
+    const char* side = e.side == static_cast<uint16_t>(OrderType::BUY) ? "BUY" : "SELL";
+    std::cout << e.sequence << ' ' << e.timestamp << ' ' << typeName(e.type);
+    switch (static_cast<MarketDataEventType>(e.type)) {
+        case MarketDataEventType::ADD:
+        case MarketDataEventType::CANCEL:
+        case MarketDataEventType::MODIFY:
+            std::cout << ' ' << side << " id=" << e.orderId << ' ' << e.quantity << " @ " << e.price;
+            break;
+        case MarketDataEventType::EXECUTE:
+            std::cout << ' ' << side << " id=" << e.orderId << ' ' << e.quantity << " @ " << e.price
+                      << " aggressor=" << e.otherId << " trade=" << e.tradeId;
+            break;
+        case MarketDataEventType::LEVEL:
+            std::cout << ' ' << side << ' ' << e.price << " qty" << (e.quantity >= 0 ? "+" : "") << e.quantity
+                      << " orders" << (e.otherId >= 0 ? "+" : "") << e.otherId;
+            break;
+        default:
+            break;
+    }
+    std::cout << '\n';
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: md_tail FEED [--rewind] [--snapshot] [--no-follow]" << std::endl;
+        return 1;
+    }
+    bool rewind = false, snapshot = false, follow = true;
+    for (int i = 2; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--rewind") == 0) {
+            rewind = true;
+        } else if (std::strcmp(argv[i], "--snapshot") == 0) {
+            snapshot = true;
+        } else if (std::strcmp(argv[i], "--no-follow") == 0) {
+            follow = false;
+        } else {
+            std::cerr << "Unknown option: " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    try {
+        MarketDataReader reader(argv[1]);
+        if (rewind) reader.rewind();
+        if (snapshot) reader.requestSnapshot();
+
+        MarketDataEvent event;
+        unsigned idle = 0;
+        while (true) {
+            switch (reader.next(event)) {
+                case MarketDataReader::Result::EVENT:
+                    idle = 0;
+                    print(event);
+                    break;
+                case MarketDataReader::Result::GAP:
+                    std::cout << "GAP: " << reader.lostEvents() << " events lost so far, resuming at "
+                              << reader.expectedSequence() << '\n';
+                    reader.requestSnapshot();
+                    break;
+                case MarketDataReader::Result::EMPTY:
+                    if (!follow) return 0;
+                    std::cout.flush();
+                    // Same back-off as the engine's idle threads.
+                    if (++idle < 1024) continue;
+                    std::this_thread::sleep_for(std::chrono::microseconds(50));
+                    break;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
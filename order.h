@@ -3,11 +3,28 @@
 
 #include <string>
 #include <chrono>
+#include <cstdint>
+#include <limits>
+#include <optional>
+
+// Order and trade ids are 64-bit so they never wrap, however busy the day.
+using OrderId = int64_t;
+
+// Nanoseconds since the Unix epoch.
+using Timestamp = int64_t;
 
 // Enums define the possible states and types for orders.
-enum class OrderType { BUY, SELL };
+enum class OrderType : uint8_t { BUY, SELL };
 enum class OrderStatus { OPEN, PARTIAL, FILLED, CANCELLED };
 
+// How long an incoming order may wait for a match. GTC rests whatever does not
+// fill; IOC drops the unfilled remainder; FOK fills in full or not at all.
+enum class TimeInForce : uint8_t { GTC, IOC, FOK };
+
+// A limit order never trades through its price; a market order takes whatever
+// the other side offers at any price and never rests (IOC or FOK only).
+enum class OrderKind : uint8_t { LIMIT, MARKET };
+
 // Utility functions to convert enums to human-readable strings.
 inline std::string statusToStr(OrderStatus status) {
     switch (status) {
@@ -23,14 +40,21 @@ inline std::string typeToStr(OrderType type) {
     return type == OrderType::BUY ? "BUY" : "SELL";
 }
 
-// Represents a single order in the book.
-struct Order {
-    int id;
+// The hot half of an order: everything the matching loop reads while it walks
+// a level, packed into 32 bytes and aligned so that no order straddles a cache
+// line and two share one. Pooled orders keep the rest in an OrderInfo beside
+// them (see OrderPool::info).
+struct alignas(32) Order {
+    OrderId id;
     OrderType type;
+    TimeInForce timeInForce = TimeInForce::GTC;
+    OrderKind kind = OrderKind::LIMIT;
     int price;
     int quantity;
     int filled_quantity = 0;
-    time_t timestamp;
+
+    // Intrusive link to the next order in the FIFO of the level it rests at.
+    Order* next = nullptr;
 
     // Calculates the remaining quantity to be filled.
     int remaining() const { return quantity - filled_quantity; }
@@ -38,15 +62,42 @@ struct Order {
     // Checks if the order has been completely filled.
     bool is_filled() const { return remaining() == 0; }
 };
+static_assert(sizeof(Order) == 32 && alignof(Order) == 32, "Order must stay half a cache line");
+
+// The cold half of a pooled order: read when an order is placed, cancelled,
+// amended or saved, never while matching.
+struct OrderInfo {
+    Order* prev = nullptr; // previous order in the level; not kept up to date for the level's head
+    Order* ownerPrev = nullptr; // links into the list of live orders with the same owner
+    Order* ownerNext = nullptr;
+    Timestamp timestamp = 0;
+    uint16_t owner = 0; // session that placed the order, 0 if none
+};
+static_assert(sizeof(OrderInfo) == 40, "OrderInfo grew; check OrderPool's slab geometry");
+
+// An order outside the book with its cold fields alongside, as the CSV books store it.
+struct SavedOrder {
+    Order order;
+    Timestamp timestamp = 0;
+    uint16_t owner = 0;
+};
+
+// Selects the resting orders a mass cancel removes: those that match every field.
+struct MassCancelFilter {
+    std::optional<OrderType> side; // both sides when empty
+    int minPrice = 0;              // inclusive price band
+    int maxPrice = std::numeric_limits<int>::max();
+    uint16_t owner = 0;            // orders of this owner only; 0 for any owner
+};
 
 // Represents a completed trade between a buy and a sell order.
 struct Trade {
-    int tradeId;
-    int buyOrderId;
-    int sellOrderId;
+    int64_t tradeId;
+    OrderId buyOrderId;
+    OrderId sellOrderId;
     int price;
     int quantity;
-    time_t timestamp;
+    Timestamp timestamp;
 };
 
 #endif // ORDER_H
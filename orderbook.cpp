@@ -1,169 +1,797 @@
 #include "OrderBook.h"
 #include <iostream>
 #include <algorithm> // for std::max
+#include <chrono>
+#include <filesystem>
 
-OrderBook::OrderBook(std::shared_ptr<Logger> logger) : logger(logger) {
-    persistence = std::make_unique<PersistenceManager>("buy_orders.csv", "sell_orders.csv", "trades.csv");
+namespace {
+
+// Where a book keeps one of its files.
+std::string dataPath(const OrderBookConfig& config, const char* file) {
+    if (config.dataDir.empty()) return file;
+    return config.dataDir + "/" + file;
+}
+
+// Shared files named with an absolute path are used as is, others live in dataDir.
+std::string sharedPath(const OrderBookConfig& config, const std::string& file) {
+    return file[0] == '/' ? file : dataPath(config, file.c_str());
+}
+
+// A restored order as addRestingOrders takes it, from either source.
+const SavedOrder& toSaved(const SavedOrder& saved) { return saved; }
+
+SavedOrder toSaved(const SnapshotOrder& o) {
+    return SavedOrder{Order{o.id, static_cast<OrderType>(o.side), TimeInForce::GTC, OrderKind::LIMIT, o.price,
+                            o.quantity, o.filled},
+                      o.timestamp, static_cast<uint16_t>(o.owner)};
+}
+
+// Copies up to maxLevels of the best levels of one side into out. Levels keep
+// their own totals, so this touches maxLevels levels and no orders.
+template <typename TBook>
+std::size_t collectDepth(const TBook& side, DepthLevel* out, std::size_t maxLevels) {
+    std::size_t count = 0;
+    if (maxLevels == 0) return 0;
+    side.forEachLevel([&](int price, const PriceLevel& level) {
+        out[count++] = DepthLevel{price, static_cast<int32_t>(level.count), level.quantity};
+        return count < maxLevels;
+    });
+    return count;
+}
+
+} // namespace
+
+OrderBook::OrderBook(std::shared_ptr<Logger> logger, const OrderBookConfig& config)
+    : orderPool(config.orderPoolCapacity), allOrders(config.orderPoolCapacity), logger(logger),
+      snapshotFile(dataPath(config, "orders.snapshot")), snapshotInterval(config.snapshotInterval),
+      importThreads(config.importThreads), quiet(config.quiet),
+      clock(config.clock ? config.clock : std::make_shared<CalibratedClock>()) {
+    if (config.persist) {
+        statsFile = dataPath(config, "stats.txt");
+        persistence = std::make_unique<PersistenceManager>(dataPath(config, "buy_orders.csv"), dataPath(config, "sell_orders.csv"),
+                                                           dataPath(config, "trades.csv"), config.tradeCommit);
+        journal = std::make_unique<Journal>(dataPath(config, "orders.journal"), config.tradeCommit.durability);
+    }
     matchingEngine = std::make_unique<MatchingEngine>();
 
     logger->log("System", "Order book initializing...");
+
+    if (config.useLadder) {
+        buyOrders.useLadder(config.ladderMinPrice, config.ladderMaxPrice);
+        sellOrders.useLadder(config.ladderMinPrice, config.ladderMaxPrice);
+        logger->log("System", "Using price ladder " + std::to_string(config.ladderMinPrice) +
+                    "-" + std::to_string(config.ladderMaxPrice));
+    }
+    buyOrders.reserveLevels(config.levelPoolCapacity);
+    sellOrders.reserveLevels(config.levelPoolCapacity);
     
-    // Load existing orders and reconstruct the state
-    persistence->loadOrders(buyOrders, sellOrders);
+    if (config.persist) {
+        recover();
+    } else {
+        logger->log("System", "Persistence is off; the book starts empty and is not saved.");
+    }
+
+    // The start-up market data snapshot and depth view are stamped like a command.
+    stampCommand();
+    if (!config.marketDataFile.empty()) {
+        std::string feedPath = sharedPath(config, config.marketDataFile);
+        marketData = std::make_unique<MarketDataFeed>(feedPath, config.marketDataCapacity);
+        marketData->setTimestamp(commandTime);
+        publishMarketDataSnapshot();
+        logger->log("System", "Publishing market data to " + feedPath);
+    }
+    if (!config.depthFile.empty()) {
+        std::string depthPath = sharedPath(config, config.depthFile);
+        depthPublisher = std::make_unique<DepthPublisher>(depthPath);
+        publishDepth();
+        logger->log("System", "Publishing book depth to " + depthPath);
+    }
+    if (!config.recordFile.empty()) startRecording(config);
     
-    // Populate the allOrders map from the loaded books
-    for(const auto& pair : buyOrders) {
-        auto q = pair.second;
-        while(!q.empty()) {
-            Order o = q.front();
-            allOrders[o.id] = o;
-            nextOrderId = std::max(nextOrderId, o.id + 1);
-            q.pop();
+    logger->log("System", "Order book initialized successfully.");
+}
+
+// Rebuilds the book: snapshot first, then the journal events written after it.
+// Without either, the CSV books are loaded and used to seed the journal.
+void OrderBook::recover() {
+    auto start = std::chrono::steady_clock::now();
+
+    Snapshot snapshot;
+    bool haveSnapshot = snapshot.load(snapshotFile);
+    uint64_t replayFrom = journal->baseSequence();
+    if (haveSnapshot) {
+        addRestingOrders(snapshot.orders(), snapshot.orderCount(), false);
+        nextOrderId = std::max(nextOrderId, snapshot.state().nextOrderId);
+        nextTradeId = std::max(nextTradeId, snapshot.state().nextTradeId);
+        replayFrom = snapshot.state().journalSequence;
+        if (journal->baseSequence() > replayFrom) {
+            logger->log("Error", "Journal starts after the snapshot; events in between are missing.");
         }
+    } else if (journal->baseSequence() > 0) {
+        logger->log("Error", "Journal was compacted but no snapshot was found; recovering from the journal only.");
     }
-    for(const auto& pair : sellOrders) {
-        auto q = pair.second;
-        while(!q.empty()) {
-            Order o = q.front();
-            allOrders[o.id] = o;
-            nextOrderId = std::max(nextOrderId, o.id + 1);
-            q.pop();
+
+    std::size_t replayed = 0;
+    if (haveSnapshot || journal->recordCount() > 0) {
+        // The snapshot and journal are the source of truth; the CSV books are only exports.
+        journal->replay(replayFrom, [this, &replayed](const JournalRecord& record) {
+            applyJournalRecord(record);
+            ++replayed;
+        });
+        if (journal->nextSequence() < replayFrom) {
+            // The journal is older than the snapshot (or missing): continue numbering after the snapshot.
+            journal->reset(replayFrom);
         }
+    } else {
+        // No journal yet: start from the CSV books and seed the journal with them.
+        std::vector<SavedOrder> loadedBuys, loadedSells;
+        persistence->loadOrders(loadedBuys, loadedSells, importThreads);
+        addRestingOrders(loadedBuys.data(), loadedBuys.size(), true);
+        addRestingOrders(loadedSells.data(), loadedSells.size(), true);
+        journal->commit();
+
+        // Carry on numbering trades after the ones already in the trades log.
+        std::vector<Trade> loggedTrades;
+        persistence->loadTrades(loggedTrades, importThreads);
+        for (const auto& t : loggedTrades) nextTradeId = std::max(nextTradeId, t.tradeId + 1);
     }
-    
-    logger->log("System", "Order book initialized successfully.");
+
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    logger->log("System", "Recovered " + std::to_string(allOrders.size()) + " resting orders (" +
+                (haveSnapshot ? std::to_string(snapshot.orderCount()) + " from snapshot, " : std::string("no snapshot, ")) +
+                std::to_string(replayed) + " journal records replayed) in " + std::to_string(micros / 1000.0) + " ms.");
 }
 
 OrderBook::~OrderBook() {
+    if (!persistence) return;
+
     logger->log("System", "Order book shutting down. Exporting active orders...");
-    persistence->exportActiveOrders(buyOrders, sellOrders);
+    exportBook();
+    takeSnapshot();
     logger->log("System", "Export complete.");
+
+    if (!persistence->flushTrades()) {
+        logger->log("Error", "Trades could not all be committed to the trade log at shutdown.");
+    }
+    const TradeCommitStats& commits = persistence->tradeCommitStats();
+    if (commits.batches > 0) {
+        logger->log("System", "Trade log: " + std::to_string(commits.trades) + " trades in " +
+                    std::to_string(commits.batches) + " batches (max " + std::to_string(commits.maxBatchTrades) +
+                    "), avg commit " + std::to_string(commits.totalCommitNanos / commits.batches) +
+                    " ns, max " + std::to_string(commits.maxCommitNanos) + " ns.");
+    }
+    if (commits.writeFailures > 0 || commits.syncFailures > 0) {
+        logger->log("Error", "Trade log: " + std::to_string(commits.writeFailures) + " failed writes, " +
+                    std::to_string(commits.syncFailures) + " failed fdatasyncs.");
+    }
+
+    if (journal->writeFailures() > 0 || journal->syncFailures() > 0) {
+        logger->log("Error", "Journal: " + std::to_string(journal->writeFailures()) + " failed writes, " +
+                    std::to_string(journal->syncFailures()) + " failed fdatasyncs.");
+    }
+
+    if (kStatsEnabled && !stats.dump(statsFile)) {
+        logger->log("Error", "Could not write latency statistics to " + statsFile);
+    }
 }
 
-void OrderBook::placeOrder(OrderType type, int price, int quantity) {
-    if (price <= 0 || quantity <= 0) {
-        logger->log("Error", "Invalid order parameters: price and quantity must be positive.");
-        throw std::invalid_argument("Price and quantity must be positive");
+void OrderBook::exportBook() {
+    if (!persistence) return;
+    EngineStats::Ticks start = EngineStats::now();
+    persistence->exportActiveOrders(buyOrders, sellOrders);
+    stats.record(Stage::EXPORT, EngineStats::now() - start);
+}
+
+void OrderBook::printStats(std::ostream& out) const {
+    stats.print(out);
+}
+
+void OrderBook::takeSnapshot() {
+    if (!journal) return;
+    EngineStats::Ticks start = EngineStats::now();
+    journal->commit();
+    SnapshotState state;
+    state.nextOrderId = nextOrderId;
+    state.nextTradeId = nextTradeId;
+    state.journalSequence = journal->nextSequence();
+    Snapshot::write(snapshotFile, buyOrders, sellOrders, state);
+    // The snapshot is on disk (write() synced it and its directory) and covers
+    // every journaled event, so the journal can start over.
+    journal->reset(state.journalSequence);
+    stats.record(Stage::SNAPSHOT, EngineStats::now() - start);
+}
+
+// Takes a snapshot once the journal tail has grown past the configured interval.
+void OrderBook::maybeSnapshot() {
+    if (journal && snapshotInterval > 0 && journal->nextSequence() - journal->baseSequence() >= snapshotInterval) {
+        takeSnapshot();
     }
+}
 
-    Order order{
-        nextOrderId++,
-        type,
-        price,
-        quantity,
-        0, // filled_quantity
-        getCurrentTimestamp()
-    };
+OrderId OrderBook::placeOrder(OrderType type, int price, int quantity, TimeInForce timeInForce, uint16_t owner) {
+    return submitOrder(Order{0, type, timeInForce, OrderKind::LIMIT, price, quantity}, owner);
+}
 
-    allOrders[order.id] = order;
-    
-    logger->log("Order", "Placing " + typeToStr(type) + " order ID " + 
-                std::to_string(order.id) + " for " + std::to_string(quantity) + 
-                " @ " + std::to_string(price));
+OrderId OrderBook::placeMarketOrder(OrderType type, int quantity, TimeInForce timeInForce, uint16_t owner) {
+    return submitOrder(Order{0, type, timeInForce, OrderKind::MARKET, 0, quantity}, owner);
+}
 
-    std::vector<Trade> trades;
-    if (type == OrderType::BUY) {
-        trades = matchingEngine->matchBuyOrder(allOrders.at(order.id), sellOrders, nextTradeId);
+// Validates, matches and (for GTC limit orders) rests one incoming order.
+OrderId OrderBook::submitOrder(const Order& incoming, uint16_t owner) {
+    EngineStats::Ticks start = EngineStats::now();
+    stampCommand();
+    if (recorder) recorder->recordPlace(incoming, owner, commandTime);
+    OrderType type = incoming.type;
+    int price = incoming.price;
+    int quantity = incoming.quantity;
+    if (incoming.kind == OrderKind::MARKET) {
+        if (quantity <= 0) {
+            stats.countReject();
+            logger->log("Error", "Invalid order parameters: quantity must be positive.");
+            throw std::invalid_argument("Quantity must be positive");
+        }
+        if (incoming.timeInForce == TimeInForce::GTC) {
+            stats.countReject();
+            logger->log("Error", "Invalid order parameters: market orders must be IOC or FOK.");
+            throw std::invalid_argument("Market orders must be IOC or FOK");
+        }
     } else {
-        trades = matchingEngine->matchSellOrder(allOrders.at(order.id), buyOrders, nextTradeId);
+        if (price <= 0 || quantity <= 0) {
+            stats.countReject();
+            logger->log("Error", "Invalid order parameters: price and quantity must be positive.");
+            throw std::invalid_argument("Price and quantity must be positive");
+        }
+        if (!buyOrders.accepts(price)) {
+            stats.countReject();
+            logger->log("Error", "Invalid order parameters: price " + std::to_string(price) + " is outside the price ladder.");
+            throw std::invalid_argument("Price is outside the configured price ladder");
+        }
+    }
+    if (incoming.timeInForce == TimeInForce::FOK) {
+        // Decided from the level totals alone, so a killed order never touches the book.
+        bool fillable = type == OrderType::BUY ? matchingEngine->canFill<BuySide>(incoming, sellOrders)
+                                               : matchingEngine->canFill<SellSide>(incoming, buyOrders);
+        if (!fillable) {
+            stats.countReject();
+            logger->event<LogEvent::ORDER_KILLED>(type, quantity, price);
+            throw std::runtime_error("Fill-or-kill order cannot be filled in full");
+        }
+    }
+
+    OrderId id = nextOrderId++;
+    Order& order = *orderPool.acquire(incoming, commandTime, owner);
+    order.id = id;
+    allOrders.insert(id, &order);
+    owners.link(&order);
+
+    // Each stage runs as one block so that a timestamp between two blocks both
+    // ends one stage and starts the next. Fills are logged, published and
+    // recorded as the matcher produces them, so nothing is buffered per order.
+    EngineStats::Ticks matchStart = EngineStats::now();
+    logger->event<LogEvent::ORDER_PLACED>(type, order.id, quantity, price);
+    // The journal gets an order that may rest as it arrived, ahead of its fills.
+    // Orders that never rest are not journaled; replaying their fills against
+    // the resting side is enough to rebuild the book. One that did not trade
+    // either leaves just its id, which has already been published.
+    if (persistence && order.timeInForce == TimeInForce::GTC) journal->recordNew(order);
+    matchAndRest(order);
+    if (persistence && order.timeInForce != TimeInForce::GTC && order.filled_quantity == 0) {
+        journal->recordOrderId(id, commandTime);
     }
 
-    processTrades(trades);
+    EngineStats::Ticks logStart = EngineStats::now();
+    publishPendingLevel(type);
+    if (order.is_filled()) {
+        logger->event<LogEvent::ORDER_FILLED>(order.type, order.id);
+        releaseOrder(&order);
+    } else if (order.timeInForce != TimeInForce::GTC) {
+        // IOC and market remainders are dropped, never rested.
+        logger->event<LogEvent::ORDER_EXPIRED>(order.type, order.id, order.remaining());
+        releaseOrder(&order);
+    } else if (marketData) {
+        marketData->add(order);
+        marketData->level(order.type, order.price, order.remaining(), 1);
+    }
+    if (marketData && marketData->refreshRequested()) publishMarketDataSnapshot();
+    if (depthPublisher) publishDepth();
+
+    EngineStats::Ticks persistStart = EngineStats::now();
+    EngineStats::Ticks end = persistStart;
+    if (persistence) {
+        // The journal first: trades.csv is derived from it, so after a crash it
+        // may lack the last trades but never holds ids the journal has not seen.
+        journal->commit();
+        persistence->commitTrades();
+        maybeSnapshot();
+        end = EngineStats::now();
+    }
+
+    stats.countOrder();
+    stats.record(Stage::PLACE_MATCH, logStart - matchStart);
+    stats.record(Stage::PLACE_LOG, persistStart - logStart);
+    stats.record(Stage::PLACE_PERSIST, end - persistStart);
+    stats.record(Stage::PLACE, end - start);
+    return id;
+}
+
+// Matches an order that is not in the book against the other side, then links
+// what is left of it into its level if it is GTC.
+void OrderBook::matchAndRest(Order& order) {
+    auto onTrade = [this, &order](const Trade& trade, Order& resting) { reportTrade(order, trade, resting); };
+    if (order.type == OrderType::BUY) {
+        matchingEngine->matchBuyOrder(order, sellOrders, nextTradeId, commandTime, onTrade);
+    } else {
+        matchingEngine->matchSellOrder(order, buyOrders, nextTradeId, commandTime, onTrade);
+    }
 
-    // If the order is not fully filled, add it to the book.
-    if (!allOrders.at(order.id).is_filled()) {
+    if (!order.is_filled() && order.timeInForce == TimeInForce::GTC) {
         if (order.type == OrderType::BUY) {
-            buyOrders[order.price].push(allOrders.at(order.id));
+            buyOrders.push_back(&order);
         } else {
-            sellOrders[order.price].push(allOrders.at(order.id));
+            sellOrders.push_back(&order);
         }
     }
-    
-    // Persist changes after the operation
-    persistence->exportActiveOrders(buyOrders, sellOrders);
 }
 
-void OrderBook::processTrades(const std::vector<Trade>& trades) {
-    if(trades.empty()) return;
+// Publishes the last level change left by an incoming order's fills.
+void OrderBook::publishPendingLevel(OrderType incomingSide) {
+    if (marketData && pendingLevel.quantity != 0) {
+        OrderType restingSide = incomingSide == OrderType::BUY ? OrderType::SELL : OrderType::BUY;
+        marketData->level(restingSide, pendingLevel.price, pendingLevel.quantity, pendingLevel.orders);
+        pendingLevel = LevelChange{};
+    }
+}
+
+// Handles one fill of an incoming order as the matcher produces it: logs and
+// records the trade, publishes the execution and releases the resting order
+// if it is now filled (the matcher has already unlinked it from its level).
+void OrderBook::reportTrade(const Order& incoming, const Trade& trade, Order& resting) {
+    ++tradesMatched;
+    stats.countTrades(1);
+    logger->event<LogEvent::TRADE_MATCHED>(trade.quantity, trade.price, trade.buyOrderId, trade.sellOrderId);
 
-    for (const auto& trade : trades) {
-        logger->log("Trade", "Matched " + std::to_string(trade.quantity) + 
-                   " units at price " + std::to_string(trade.price) + 
-                   " (Buy:" + std::to_string(trade.buyOrderId) + 
-                   " Sell:" + std::to_string(trade.sellOrderId) + ")");
-        
+    if (!quiet) {
         std::cout << "TRADE: " << trade.quantity << " @ " << trade.price << std::endl;
+    }
 
+    bool restingFilled = resting.is_filled();
+    if (marketData) {
+        marketData->execute(resting.type, resting.id, incoming.id, trade);
+        // Consecutive fills at one price are published as a single level change.
+        if (trade.price != pendingLevel.price) {
+            if (pendingLevel.quantity != 0) {
+                marketData->level(resting.type, pendingLevel.price, pendingLevel.quantity, pendingLevel.orders);
+            }
+            pendingLevel = LevelChange{trade.price, 0, 0};
+        }
+        pendingLevel.quantity -= trade.quantity;
+        if (restingFilled) --pendingLevel.orders;
+    }
+    if (depthPublisher) {
+        depthPublisher->view().lastTradePrice = trade.price;
+        depthPublisher->view().lastTradeQuantity = trade.quantity;
+    }
+    if (persistence) {
         persistence->logTrade(trade);
+        journal->recordFill(trade);
+    }
 
-        // Update the master list of orders
-        // allOrders.at(trade.buyOrderId).filled_quantity += trade.quantity;
-        // allOrders.at(trade.sellOrderId).filled_quantity += trade.quantity;
+    if (restingFilled) {
+        logger->event<LogEvent::ORDER_FILLED>(resting.type, resting.id);
+        releaseOrder(&resting);
     }
+}
 
-    // Clean up filled orders from the master list
-    for (const auto& trade : trades) {
-        if (allOrders.at(trade.buyOrderId).is_filled()) {
-            logger->log("Order", "Buy order " + std::to_string(trade.buyOrderId) + " is fully FILLED.");
+// Whether a saved order can be restored, logging why not.
+bool OrderBook::canRestore(const Order& loaded) {
+    if (!buyOrders.accepts(loaded.price)) {
+        logger->log("Error", "Skipping saved order ID " + std::to_string(loaded.id) + " priced outside the price ladder");
+        return false;
+    }
+    if (allOrders.find(loaded.id)) {
+        logger->log("Error", "Skipping duplicate saved order ID " + std::to_string(loaded.id));
+        return false;
+    }
+    return true;
+}
+
+// Links an order recovered from disk into the book. Returns nullptr if it is skipped.
+Order* OrderBook::addRestingOrder(const Order& loaded, Timestamp timestamp, uint16_t owner) {
+    if (!canRestore(loaded)) return nullptr;
+
+    Order& order = *orderPool.acquire(loaded, timestamp, owner);
+    allOrders.insert(order.id, &order);
+    owners.link(&order);
+    if (order.type == OrderType::BUY) {
+        buyOrders.push_back(&order);
+    } else {
+        sellOrders.push_back(&order);
+    }
+    nextOrderId = std::max(nextOrderId, order.id + 1);
+    return &order;
+}
+
+// Restores count saved orders, given side by side in queue order, optionally
+// journaling each. Consecutive orders usually share a price (both the CSV books
+// and snapshots are written level by level): each such run is linked up first
+// and then spliced into its level with a single lookup.
+template <typename Record>
+void OrderBook::addRestingOrders(const Record* loaded, std::size_t count, bool journalNew) {
+    std::size_t i = 0;
+    while (i < count) {
+        const SavedOrder& head = toSaved(loaded[i]);
+        int price = head.order.price;
+        OrderType type = head.order.type;
+        Order* first = nullptr;
+        Order* last = nullptr;
+        for (; i < count; ++i) {
+            const SavedOrder& saved = toSaved(loaded[i]);
+            if (saved.order.price != price || saved.order.type != type) break;
+            if (!canRestore(saved.order)) continue;
+            Order* order = orderPool.acquire(saved.order, saved.timestamp, saved.owner);
+            allOrders.insert(order->id, order);
+            owners.link(order);
+            OrderPool::info(order).prev = last;
+            if (last) {
+                last->next = order;
+            } else {
+                first = order;
+            }
+            last = order;
+            nextOrderId = std::max(nextOrderId, order->id + 1);
+            if (journalNew) journal->recordNew(*order);
+        }
+        if (!first) continue;
+        if (type == OrderType::BUY) {
+            buyOrders.appendRun(price, first, last);
+        } else {
+            sellOrders.appendRun(price, first, last);
+        }
+    }
+}
+
+
+// Re-applies one journaled event to the book during recovery.
+void OrderBook::applyJournalRecord(const JournalRecord& record) {
+    switch (static_cast<JournalEventType>(record.type)) {
+        case JournalEventType::NEW: {
+            Order order{record.orderId, static_cast<OrderType>(record.side), TimeInForce::GTC, OrderKind::LIMIT,
+                        record.price, record.quantity, record.filled};
+            addRestingOrder(order, record.timestamp, static_cast<uint16_t>(record.otherId));
+            nextOrderId = std::max(nextOrderId, record.orderId + 1);
+            break;
         }
-        if (allOrders.at(trade.sellOrderId).is_filled()) {
-            logger->log("Order", "Sell order " + std::to_string(trade.sellOrderId) + " is fully FILLED.");
+        case JournalEventType::FILL: {
+            // An incoming order was journaled before it matched, so both sides are in the book here.
+            for (OrderId id : {record.orderId, record.otherId}) {
+                Order* order = allOrders.find(id);
+                if (!order) continue;
+                if (order->type == OrderType::BUY) {
+                    buyOrders.fill(order, record.quantity);
+                } else {
+                    sellOrders.fill(order, record.quantity);
+                }
+                if (order->is_filled()) {
+                    unlinkOrder(order);
+                    releaseOrder(order);
+                }
+            }
+            // Orders that never rested are only seen here, so keep their ids used too.
+            nextOrderId = std::max(nextOrderId, std::max(record.orderId, record.otherId) + 1);
+            nextTradeId = std::max(nextTradeId, record.tradeId + 1);
+            break;
+        }
+        case JournalEventType::MODIFY: {
+            Order* order = allOrders.find(record.orderId);
+            if (!order) break;
+            bool buy = order->type == OrderType::BUY;
+            if (record.price == order->price && record.quantity <= order->quantity) {
+                if (buy) {
+                    buyOrders.resize(order, record.quantity);
+                } else {
+                    sellOrders.resize(order, record.quantity);
+                }
+                break;
+            }
+            // Re-queued: the fills it caused follow as FILL records, as for NEW.
+            unlinkOrder(order);
+            order->price = record.price;
+            order->quantity = record.quantity;
+            OrderPool::info(order).timestamp = record.timestamp;
+            if (buy) {
+                buyOrders.push_back(order);
+            } else {
+                sellOrders.push_back(order);
+            }
+            break;
         }
+        case JournalEventType::CANCEL: {
+            if (Order* order = allOrders.find(record.orderId)) {
+                unlinkOrder(order);
+                releaseOrder(order);
+            }
+            break;
+        }
+        case JournalEventType::MASS_CANCEL: {
+            MassCancelFilter filter;
+            if (record.side != kJournalBothSides) filter.side = static_cast<OrderType>(record.side);
+            filter.minPrice = record.price;
+            filter.maxPrice = record.quantity;
+            filter.owner = static_cast<uint16_t>(record.otherId);
+            cancelMatching(filter);
+            break;
+        }
+        case JournalEventType::ORDER_ID:
+            nextOrderId = std::max(nextOrderId, record.orderId + 1);
+            break;
     }
 }
 
 
-void OrderBook::cancelOrder(int id) {
-    if (allOrders.find(id) == allOrders.end()) {
+void OrderBook::cancelOrder(OrderId id) {
+    EngineStats::Ticks start = EngineStats::now();
+    stampCommand();
+    if (recorder) recorder->recordCancel(id, commandTime);
+    Order* found = allOrders.find(id);
+    if (!found) {
+        stats.countReject();
         logger->log("Error", "Cancel failed - order ID " + std::to_string(id) + " not found");
         throw std::runtime_error("Order ID not found");
     }
 
-    Order& order_to_cancel = allOrders.at(id);
+    Order& order_to_cancel = *found;
     
     if (order_to_cancel.is_filled()) {
+        stats.countReject();
         logger->log("Error", "Cannot cancel already filled order ID " + std::to_string(id));
         throw std::runtime_error("Cannot cancel a filled order.");
     }
 
-    bool removed = false;
-    auto type = order_to_cancel.type;
-    auto price = order_to_cancel.price;
+    bool removed = unlinkOrder(&order_to_cancel);
 
-    auto removeFromQueue = [&](std::queue<Order>& q) {
-        std::queue<Order> newQ;
-        while (!q.empty()) {
-            Order o = q.front();
-            q.pop();
-            if (o.id != id) {
-                newQ.push(o);
-            } else {
-                removed = true;
-            }
+    if (removed) {
+        EngineStats::Ticks logStart = EngineStats::now();
+        logger->event<LogEvent::ORDER_CANCELLED>(id);
+        if (marketData) {
+            marketData->cancel(order_to_cancel);
+            marketData->level(order_to_cancel.type, order_to_cancel.price, -order_to_cancel.remaining(), -1);
+            if (marketData->refreshRequested()) publishMarketDataSnapshot();
         }
-        q = newQ;
-    };
+        releaseOrder(found);
+        if (depthPublisher) publishDepth();
+        EngineStats::Ticks persistStart = EngineStats::now();
+        EngineStats::Ticks end = persistStart;
+        if (journal) {
+            journal->recordCancel(id, commandTime);
+            journal->commit();
+            maybeSnapshot();
+            end = EngineStats::now();
+        }
+        stats.countCancel();
+        stats.record(Stage::CANCEL_LOG, persistStart - logStart);
+        stats.record(Stage::CANCEL_PERSIST, end - persistStart);
+        stats.record(Stage::CANCEL, end - start);
+    } else {
+        stats.countReject();
+        logger->log("Error", "Order ID " + std::to_string(id) + " not found in active book (might be filled).");
+        throw std::runtime_error("Order ID not found in active order book.");
+    }
+}
+
+
+void OrderBook::modifyOrder(OrderId id, int newPrice, int newQuantity) {
+    EngineStats::Ticks start = EngineStats::now();
+    stampCommand();
+    if (recorder) recorder->recordModify(id, newPrice, newQuantity, commandTime);
+    Order* found = allOrders.find(id);
+    if (!found) {
+        stats.countReject();
+        logger->log("Error", "Modify failed - order ID " + std::to_string(id) + " not found");
+        throw std::runtime_error("Order ID not found");
+    }
+    Order& order = *found;
+    if (newPrice <= 0 || newQuantity <= 0) {
+        stats.countReject();
+        logger->log("Error", "Invalid modify parameters: price and quantity must be positive.");
+        throw std::invalid_argument("Price and quantity must be positive");
+    }
+    if (!buyOrders.accepts(newPrice)) {
+        stats.countReject();
+        logger->log("Error", "Invalid modify parameters: price " + std::to_string(newPrice) + " is outside the price ladder.");
+        throw std::invalid_argument("Price is outside the configured price ladder");
+    }
+    if (newQuantity <= order.filled_quantity) {
+        stats.countReject();
+        logger->log("Error", "Modify failed - order ID " + std::to_string(id) + " has already filled " +
+                    std::to_string(order.filled_quantity));
+        throw std::invalid_argument("New quantity must exceed the quantity already filled");
+    }
 
-    if (type == OrderType::BUY) {
-        if(buyOrders.count(price)) {
-            removeFromQueue(buyOrders[price]);
-            if (buyOrders[price].empty()) buyOrders.erase(price);
+    logger->event<LogEvent::ORDER_MODIFIED>(order.type, id, newQuantity, newPrice);
+    int oldRemaining = order.remaining();
+    if (newPrice == order.price && newQuantity <= order.quantity) {
+        // A size-down at the same price keeps the order's place in the queue.
+        if (order.type == OrderType::BUY) {
+            buyOrders.resize(&order, newQuantity);
+        } else {
+            sellOrders.resize(&order, newQuantity);
         }
-    } else { // SELL
-        if(sellOrders.count(price)) {
-            removeFromQueue(sellOrders[price]);
-            if (sellOrders[price].empty()) sellOrders.erase(price);
+        if (persistence) journal->recordModify(order);
+        if (marketData) {
+            marketData->modify(order);
+            marketData->level(order.type, order.price, order.remaining() - oldRemaining, 0);
+        }
+    } else {
+        // Anything else re-enters the book as if newly placed: at the back of
+        // its new level, matching first if the new price crosses.
+        unlinkOrder(&order);
+        if (marketData) marketData->level(order.type, order.price, -oldRemaining, -1);
+        order.price = newPrice;
+        order.quantity = newQuantity;
+        OrderPool::info(&order).timestamp = commandTime;
+        if (persistence) journal->recordModify(order);
+        matchAndRest(order);
+        publishPendingLevel(order.type);
+        if (marketData) {
+            marketData->modify(order);
+            if (!order.is_filled()) marketData->level(order.type, order.price, order.remaining(), 1);
+        }
+        if (order.is_filled()) {
+            logger->event<LogEvent::ORDER_FILLED>(order.type, id);
+            releaseOrder(&order);
         }
     }
+    if (marketData && marketData->refreshRequested()) publishMarketDataSnapshot();
+    if (depthPublisher) publishDepth();
 
-    if (removed) {
-        allOrders.erase(id);
-        logger->log("Order", "Cancelled order ID " + std::to_string(id));
-        persistence->exportActiveOrders(buyOrders, sellOrders);
-    } else {
-        logger->log("Error", "Order ID " + std::to_string(id) + " not found in active book (might be filled).");
-        throw std::runtime_error("Order ID not found in active order book.");
+    if (persistence) {
+        journal->commit();
+        persistence->commitTrades();
+        maybeSnapshot();
+    }
+    stats.countModify();
+    stats.record(Stage::MODIFY, EngineStats::now() - start);
+}
+
+
+std::size_t OrderBook::massCancel(const MassCancelFilter& filter) {
+    EngineStats::Ticks start = EngineStats::now();
+    stampCommand();
+    if (recorder) recorder->recordMassCancel(filter, commandTime);
+    if (filter.minPrice > filter.maxPrice) {
+        stats.countReject();
+        logger->log("Error", "Invalid mass cancel: lowest price " + std::to_string(filter.minPrice) +
+                    " is above highest price " + std::to_string(filter.maxPrice));
+        throw std::invalid_argument("Mass cancel price band is empty");
+    }
+
+    std::size_t cancelled = cancelMatching(filter);
+    logger->event<LogEvent::MASS_CANCELLED>(cancelled, filter.owner, filter.minPrice, filter.maxPrice);
+    if (marketData && marketData->refreshRequested()) publishMarketDataSnapshot();
+    if (depthPublisher) publishDepth();
+    if (journal && cancelled > 0) {
+        journal->recordMassCancel(filter, commandTime);
+        journal->commit();
+        maybeSnapshot();
+    }
+    stats.countCancel(cancelled);
+    stats.record(Stage::MASS_CANCEL, EngineStats::now() - start);
+    return cancelled;
+}
+
+
+// Removes and releases the resting orders a mass cancel selects, publishing
+// each cancel and the level changes. Shared with journal replay.
+std::size_t OrderBook::cancelMatching(const MassCancelFilter& filter) {
+    bool buys = !filter.side || *filter.side == OrderType::BUY;
+    bool sells = !filter.side || *filter.side == OrderType::SELL;
+    std::size_t cancelled = 0;
+
+    if (filter.owner != 0) {
+        // One owner's orders are usually a small part of the band, so walk those instead.
+        Order* next = nullptr;
+        for (Order* order = owners.first(filter.owner); order; order = next) {
+            next = OrderPool::info(order).ownerNext;
+            if (!(order->type == OrderType::BUY ? buys : sells)) continue;
+            if (order->price < filter.minPrice || order->price > filter.maxPrice) continue;
+            unlinkOrder(order);
+            if (marketData) {
+                marketData->cancel(*order);
+                marketData->level(order->type, order->price, -order->remaining(), -1);
+            }
+            releaseOrder(order);
+            ++cancelled;
+        }
+        return cancelled;
     }
+
+    // Every order of a level in the band goes, so the levels are dropped whole
+    // and the orders released without unlinking them one by one.
+    auto releaseLevel = [this, &cancelled](OrderType type, int price, PriceLevel& level) {
+        Order* next = nullptr;
+        for (Order* order = level.head; order; order = next) {
+            next = order->next;
+            if (marketData) marketData->cancel(*order);
+            releaseOrder(order);
+            ++cancelled;
+        }
+        if (marketData) marketData->level(type, price, -static_cast<int>(level.quantity), -static_cast<int>(level.count));
+    };
+    if (buys) {
+        buyOrders.removeLevels(filter.minPrice, filter.maxPrice,
+                               [&](int price, PriceLevel& level) { releaseLevel(OrderType::BUY, price, level); });
+    }
+    if (sells) {
+        sellOrders.removeLevels(filter.minPrice, filter.maxPrice,
+                                [&](int price, PriceLevel& level) { releaseLevel(OrderType::SELL, price, level); });
+    }
+    return cancelled;
+}
+
+
+// Unlinks a resting order from its price level. The order knows its neighbours,
+// so this does not touch the rest of the level.
+bool OrderBook::unlinkOrder(Order* order) {
+    return order->type == OrderType::BUY ? buyOrders.remove(order) : sellOrders.remove(order);
+}
+
+
+// Drops an order that is no longer linked into the book and recycles its node.
+void OrderBook::releaseOrder(Order* order) {
+    allOrders.erase(order->id);
+    owners.unlink(order);
+    orderPool.release(order);
+}
+
+
+// Publishes the whole book as a market data snapshot: a reset, then every
+// resting order and every level's totals, best price first.
+void OrderBook::publishMarketDataSnapshot() {
+    marketData->bookReset();
+    auto publishSide = [this](const auto& side, OrderType type) {
+        side.forEachLevel([this, type](int price, const PriceLevel& level) {
+            for (const Order* order = level.head; order; order = order->next) marketData->add(*order);
+            marketData->level(type, price, static_cast<int>(level.quantity), static_cast<int>(level.count));
+            return true;
+        });
+    };
+    publishSide(buyOrders, OrderType::BUY);
+    publishSide(sellOrders, OrderType::SELL);
+    marketData->snapshotEnd();
+}
+
+std::size_t OrderBook::depth(OrderType side, DepthLevel* out, std::size_t maxLevels) const {
+    return side == OrderType::BUY ? collectDepth(buyOrders, out, maxLevels) : collectDepth(sellOrders, out, maxLevels);
+}
+
+// Refreshes the shared depth view from the book.
+void OrderBook::publishDepth() {
+    DepthView& view = depthPublisher->view();
+    ++view.commands;
+    view.timestamp = commandTime;
+    view.bidLevels = static_cast<uint32_t>(depth(OrderType::BUY, view.bids, kDepthLevels));
+    view.askLevels = static_cast<uint32_t>(depth(OrderType::SELL, view.asks, kDepthLevels));
+    depthPublisher->publish();
+}
+
+const TradeCommitStats& OrderBook::tradeCommitStats() const {
+    static const TradeCommitStats none;
+    return persistence ? persistence->tradeCommitStats() : none;
+}
+
+PoolStats OrderBook::poolStats() const {
+    return PoolStats{
+        orderPool.capacity(),
+        orderPool.inUse(),
+        orderPool.highWater(),
+        orderPool.growths(),
+        allOrders.capacity(),
+        allOrders.growths(),
+        buyOrders.levelCount(),
+        sellOrders.levelCount(),
+        buyOrders.spareLevelCount() + sellOrders.spareLevelCount(),
+        buyOrders.levelAllocations() + sellOrders.levelAllocations()
+    };
 }
 
 
@@ -171,15 +799,17 @@ void OrderBook::showBook() const {
     std::cout << "\n--- ORDER BOOK ---\n";
 
     if (!sellOrders.empty()) {
-        auto it = sellOrders.rbegin();
-        std::cout << "Top Sell: " << it->second.front().remaining() << " @ " << it->first << std::endl;
+        const PriceLevel& level = sellOrders.bestLevel();
+        std::cout << "Top Sell: " << level.quantity << " @ " << sellOrders.bestPrice() << " (" << level.count
+                  << (level.count == 1 ? " order)" : " orders)") << std::endl;
     } else {
         std::cout << "Top Sell: <empty>\n";
     }
 
     if (!buyOrders.empty()) {
-        auto it = buyOrders.begin();
-        std::cout << "Top Buy:  " << it->second.front().remaining() << " @ " << it->first << std::endl;
+        const PriceLevel& level = buyOrders.bestLevel();
+        std::cout << "Top Buy:  " << level.quantity << " @ " << buyOrders.bestPrice() << " (" << level.count
+                  << (level.count == 1 ? " order)" : " orders)") << std::endl;
     } else {
          std::cout << "Top Buy:  <empty>\n";
     }
@@ -188,6 +818,35 @@ void OrderBook::showBook() const {
 }
 
 
-time_t OrderBook::getCurrentTimestamp() const {
-    return std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+// Reads the clock once for the command about to be applied. Everything the
+// command produces (the order, its trades, journal records, log events, market
+// data and depth) carries this time.
+void OrderBook::stampCommand() {
+    commandTime = clock->now();
+    logger->setEventTime(commandTime);
+    if (marketData) marketData->setTimestamp(commandTime);
+}
+
+// Starts a new command recording from the book as it stands after recovery:
+// the book goes into a snapshot beside the recording, and the recording notes
+// how much of trades.csv predates it.
+void OrderBook::startRecording(const OrderBookConfig& config) {
+    std::string recordPath = sharedPath(config, config.recordFile);
+    RecordingInfo info;
+    if (persistence) {
+        persistence->flushTrades();
+        std::error_code ec;
+        auto size = std::filesystem::file_size(dataPath(config, "trades.csv"), ec);
+        if (!ec) info.tradesOffset = size;
+    }
+    info.useLadder = config.useLadder;
+    info.ladderMinPrice = config.ladderMinPrice;
+    info.ladderMaxPrice = config.ladderMaxPrice;
+
+    SnapshotState state;
+    state.nextOrderId = nextOrderId;
+    state.nextTradeId = nextTradeId;
+    Snapshot::write(CommandRecorder::snapshotPath(recordPath), buyOrders, sellOrders, state);
+    recorder = std::make_unique<CommandRecorder>(recordPath, info);
+    logger->log("System", "Recording inbound commands to " + recordPath);
 }
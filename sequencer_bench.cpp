@@ -0,0 +1,132 @@
+// Compares the sequencer front end with an OrderBook behind a global mutex,
+// with several producer threads placing orders at once.
+//
+// Usage: sequencer_bench [orders per producer] [producer counts...]
+//   Defaults to 100000 orders per producer with 4, 8 and 16 producers. Each
+//   run starts from an empty data directory under sequencer_bench_data/.
+#include "Sequencer.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Swallows the per-trade console output. It keeps no state, so threads can share it.
+struct NullBuffer : std::streambuf {
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+// The i-th order of a producer: prices straddle 1000 so roughly half cross.
+SequencerCommand orderFor(unsigned producer, std::size_t i) {
+    uint64_t r = (producer + 1) * 0x9E3779B97F4A7C15ull ^ (i * 0xBF58476D1CE4E5B9ull);
+    r ^= r >> 31;
+    SequencerCommand command;
+    command.side = (r & 1) ? OrderType::BUY : OrderType::SELL;
+    command.price = 990 + static_cast<int>((r >> 8) % 21);
+    command.quantity = 1 + static_cast<int>((r >> 24) % 100);
+    command.tag = i;
+    return command;
+}
+
+struct Book {
+    explicit Book(const std::string& dir) {
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+        LoggerOptions loggerOptions;
+        loggerOptions.binaryLogFile = dir + "/events.bin";
+        logger = std::make_shared<Logger>(dir + "/events.log", loggerOptions);
+        OrderBookConfig config;
+        config.dataDir = dir;
+        config.tradeCommit.durability = TradeDurability::NONE;
+        book = std::make_unique<OrderBook>(logger, config);
+    }
+
+    std::shared_ptr<Logger> logger;
+    std::unique_ptr<OrderBook> book;
+};
+
+double runMutex(unsigned producers, std::size_t orders) {
+    Book b("sequencer_bench_data/mutex-" + std::to_string(producers));
+    std::mutex bookMutex;
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (unsigned p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            for (std::size_t i = 0; i < orders; ++i) {
+                SequencerCommand o = orderFor(p, i);
+                std::lock_guard<std::mutex> lock(bookMutex);
+                // The sequencer tags each producer's orders with its owner id; so does this.
+                b.book->placeOrder(o.side, o.price, o.quantity, TimeInForce::GTC, static_cast<uint16_t>(p + 1));
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+double runSequencer(unsigned producers, std::size_t orders) {
+    Book b("sequencer_bench_data/sequencer-" + std::to_string(producers));
+    Sequencer sequencer(*b.book);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (unsigned p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            Sequencer::Producer& producer = sequencer.connect();
+            SequencerResponse response;
+            std::size_t received = 0;
+            for (std::size_t i = 0; i < orders; ++i) {
+                producer.submit(orderFor(p, i));
+                while (producer.poll(response)) ++received;
+            }
+            while (received + producer.droppedResponses() < orders) {
+                if (producer.poll(response)) {
+                    ++received;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::size_t orders = argc > 1 ? static_cast<std::size_t>(std::atol(argv[1])) : 100000;
+    std::vector<unsigned> producerCounts;
+    for (int i = 2; i < argc; ++i) producerCounts.push_back(static_cast<unsigned>(std::atoi(argv[i])));
+    if (producerCounts.empty()) producerCounts = {4, 8, 16};
+
+    // Trades are printed by the book; keep them off the terminal while measuring.
+    NullBuffer discard;
+    std::streambuf* console = std::cout.rdbuf(&discard);
+    std::streambuf* errors = std::cerr.rdbuf(&discard);
+    std::vector<std::pair<double, double>> results;
+    for (unsigned producers : producerCounts) {
+        results.emplace_back(runMutex(producers, orders), runSequencer(producers, orders));
+    }
+    std::cout.rdbuf(console);
+    std::cerr.rdbuf(errors);
+
+    for (std::size_t i = 0; i < producerCounts.size(); ++i) {
+        double total = static_cast<double>(orders) * producerCounts[i];
+        std::cout << producerCounts[i] << " producers: mutex " << static_cast<uint64_t>(total / results[i].first)
+                  << " orders/sec, sequencer " << static_cast<uint64_t>(total / results[i].second)
+                  << " orders/sec (" << results[i].first / results[i].second << "x)" << std::endl;
+    }
+    std::filesystem::remove_all("sequencer_bench_data");
+    return 0;
+}
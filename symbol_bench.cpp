@@ -0,0 +1,108 @@
+// Measures how SymbolEngine throughput scales with worker threads on a
+// multi-symbol order flow.
+//
+// Usage: symbol_bench [symbols] [orders] [max workers]
+//   Runs the same random flow (default 64 symbols, 1000000 orders) with 1, 2,
+//   4, ... workers up to max workers (default: the number of cores). Each run
+//   starts from an empty data directory under symbol_bench_data/.
+#include "SymbolEngine.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Swallows the per-trade console output. It keeps no state, so the workers can share it.
+struct NullBuffer : std::streambuf {
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+struct BenchOrder {
+    uint32_t symbol;
+    OrderType type;
+    int price;
+    int quantity;
+};
+
+std::vector<BenchOrder> makeFlow(uint32_t symbols, std::size_t orders) {
+    std::vector<BenchOrder> flow;
+    flow.reserve(orders);
+    uint64_t state = 0x2545F4914F6CDD1Dull;
+    auto next = [&state]() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    };
+    for (std::size_t i = 0; i < orders; ++i) {
+        uint64_t r = next();
+        // Prices straddle 1000 so roughly half the orders cross.
+        flow.push_back(BenchOrder{static_cast<uint32_t>(i % symbols), (r & 1) ? OrderType::BUY : OrderType::SELL,
+                                  990 + static_cast<int>((r >> 8) % 21), 1 + static_cast<int>((r >> 24) % 100)});
+    }
+    return flow;
+}
+
+double run(unsigned workers, const std::vector<std::string>& symbols, const std::vector<BenchOrder>& flow) {
+    std::string dir = "symbol_bench_data/" + std::to_string(workers);
+    std::filesystem::remove_all(dir);
+
+    SymbolEngineConfig config;
+    config.workers = workers;
+    config.dataDir = dir;
+    config.book.tradeCommit.durability = TradeDurability::NONE;
+    SymbolEngine engine(config);
+    for (const auto& symbol : symbols) engine.placeOrder(symbol, OrderType::BUY, 1, 1); // open every book
+    engine.sync();
+
+    auto start = std::chrono::steady_clock::now();
+    for (const BenchOrder& o : flow) {
+        engine.placeOrder(symbols[o.symbol], o.type, o.price, o.quantity);
+    }
+    engine.sync();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    uint32_t symbolCount = argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : 64;
+    std::size_t orders = argc > 2 ? static_cast<std::size_t>(std::atol(argv[2])) : 1000000;
+    unsigned maxWorkers = argc > 3 ? static_cast<unsigned>(std::atoi(argv[3])) : std::thread::hardware_concurrency();
+    if (symbolCount == 0 || maxWorkers == 0) {
+        std::cerr << "Usage: symbol_bench [symbols] [orders] [max workers]" << std::endl;
+        return 1;
+    }
+
+    std::vector<std::string> symbols;
+    for (uint32_t i = 0; i < symbolCount; ++i) symbols.push_back("SYM" + std::to_string(i));
+    std::vector<BenchOrder> flow = makeFlow(symbolCount, orders);
+
+    // Trades and fresh-start warnings are printed by the books; keep them off
+    // the terminal while measuring.
+    NullBuffer discard;
+    std::streambuf* console = std::cout.rdbuf(&discard);
+    std::streambuf* errors = std::cerr.rdbuf(&discard);
+    std::vector<std::pair<unsigned, double>> results;
+    for (unsigned workers = 1; workers <= maxWorkers; workers *= 2) {
+        results.emplace_back(workers, run(workers, symbols, flow));
+    }
+    std::cout.rdbuf(console);
+    std::cerr.rdbuf(errors);
+
+    double base = results.front().second;
+    for (const auto& [workers, seconds] : results) {
+        std::cout << workers << " workers: " << static_cast<uint64_t>(orders / seconds) << " orders/sec, "
+                  << "speedup " << base / seconds << "x" << std::endl;
+    }
+    std::filesystem::remove_all("symbol_bench_data");
+    return 0;
+}